@@ -3,7 +3,11 @@
 
 #include <QFileInfo>
 #include <QDir>
-#include <QRegularExpression>
+#include <QJsonDocument>
+
+// RePak writes newline delimited JSON build events to stderr with this option,
+// its regular output on stdout is only shown in the log.
+static const char* const kRepakEventsOption = "--events=json";
 
 BuildManager::BuildManager(QObject* parent)
     : QObject(parent)
@@ -20,7 +24,7 @@ BuildManager::BuildManager(QObject* parent)
     connect(m_process, &QProcess::readyReadStandardOutput,
             this, &BuildManager::onProcessReadyRead);
     connect(m_process, &QProcess::readyReadStandardError,
-            this, &BuildManager::onProcessReadyRead);
+            this, &BuildManager::onProcessEventsReadyRead);
     connect(m_process, &QProcess::errorOccurred,
             this, &BuildManager::onProcessError);
     connect(m_process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
@@ -90,7 +94,7 @@ void BuildManager::build(Project* project, const QString& repakPath)
     args << project->filePath();
 
     m_process->setWorkingDirectory(project->projectDir());
-    m_process->start(repakPath, args);
+    startProcess(repakPath, args);
 }
 
 void BuildManager::compress(const QString& pakPath, const QString& repakPath, int level, int workers)
@@ -113,7 +117,7 @@ void BuildManager::compress(const QString& pakPath, const QString& repakPath, in
     args << "-compress" << pakPath << QString::number(level) << QString::number(workers);
 
     m_process->setWorkingDirectory(QFileInfo(pakPath).absolutePath());
-    m_process->start(repakPath, args);
+    startProcess(repakPath, args);
 }
 
 void BuildManager::decompress(const QString& pakPath, const QString& repakPath)
@@ -136,7 +140,7 @@ void BuildManager::decompress(const QString& pakPath, const QString& repakPath)
     args << "-decompress" << pakPath;
 
     m_process->setWorkingDirectory(QFileInfo(pakPath).absolutePath());
-    m_process->start(repakPath, args);
+    startProcess(repakPath, args);
 }
 
 void BuildManager::cancel()
@@ -153,23 +157,55 @@ qint64 BuildManager::elapsedMs() const
     return m_timer.isValid() ? m_timer.elapsed() : 0;
 }
 
+void BuildManager::startProcess(const QString& repakPath, QStringList args)
+{
+    m_eventBuffer.clear();
+
+    args.prepend(kRepakEventsOption);
+    m_process->start(repakPath, args);
+}
+
 void BuildManager::onProcessReadyRead()
 {
     QByteArray stdOut = m_process->readAllStandardOutput();
-    QByteArray stdErr = m_process->readAllStandardError();
 
-    QString output = QString::fromLocal8Bit(stdOut) + QString::fromLocal8Bit(stdErr);
+    QString output = QString::fromLocal8Bit(stdOut);
     QStringList lines = output.split('\n', Qt::SkipEmptyParts);
 
     for (const QString& line : lines) {
         QString trimmed = line.trimmed();
         if (!trimmed.isEmpty()) {
-            parseOutput(trimmed);
             emit buildOutput(trimmed);
         }
     }
 }
 
+void BuildManager::onProcessEventsReadyRead()
+{
+    m_eventBuffer += m_process->readAllStandardError();
+
+    qsizetype lineEnd;
+    while ((lineEnd = m_eventBuffer.indexOf('\n')) >= 0) {
+        const QByteArray line = m_eventBuffer.left(lineEnd).trimmed();
+        m_eventBuffer.remove(0, lineEnd + 1);
+
+        if (line.isEmpty()) {
+            continue;
+        }
+
+        QJsonParseError parseError;
+        const QJsonDocument doc = QJsonDocument::fromJson(line, &parseError);
+
+        // Anything else on stderr, e.g. from the C runtime, is just output
+        if (parseError.error != QJsonParseError::NoError || !doc.isObject()) {
+            emit buildOutput(QString::fromLocal8Bit(line));
+            continue;
+        }
+
+        handleEvent(doc.object());
+    }
+}
+
 void BuildManager::onProcessError(QProcess::ProcessError error)
 {
     QString errorMsg;
@@ -230,47 +266,50 @@ void BuildManager::setStatus(BuildStatus status)
     }
 }
 
-void BuildManager::parseOutput(const QString& line)
+void BuildManager::handleEvent(const QJsonObject& event)
 {
-    // Parse progress from RePak output
-    // Example: "[INFO] Processing textures (250 assets)"
-    // Example: "[WARN] Texture 0x12D775... has no stream layout"
-    // Example: "[ERROR] Material references missing shader"
-
-    static QRegularExpression errorRegex(R"(\[ERROR\]\s*(.*))");
-    static QRegularExpression warnRegex(R"(\[WARN\]\s*(.*))");
-    static QRegularExpression progressRegex(R"(Processing\s+(\w+)\s+\((\d+)\s+assets?\))");
-    static QRegularExpression assetRegex(R"((\d+)\s+of\s+(\d+))");
-
-    QRegularExpressionMatch match;
-
-    // Check for errors
-    match = errorRegex.match(line);
-    if (match.hasMatch()) {
-        m_errorCount++;
-        emit buildError(match.captured(1));
-        return;
-    }
+    // See src/utils/buildevents.h in RePak for the event definitions
+    const QString type = event.value("event").toString();
 
-    // Check for warnings
-    match = warnRegex.match(line);
-    if (match.hasMatch()) {
-        m_warningCount++;
-        emit buildWarning(match.captured(1));
-        return;
+    if (type == "pakStarted") {
+        m_currentAsset = 0;
+        m_totalAssets = event.value("assetCount").toInt();
+        m_currentOperation = QString("Building %1...").arg(QFileInfo(event.value("pak").toString()).fileName());
+        emit buildProgress(m_currentAsset, m_totalAssets, m_currentOperation);
     }
-
-    // Check for progress
-    match = progressRegex.match(line);
-    if (match.hasMatch()) {
-        m_currentOperation = QString("Processing %1...").arg(match.captured(1));
+    else if (type == "assetStarted") {
+        m_currentOperation = QString("Processing %1 %2...")
+            .arg(event.value("type").toString(), event.value("asset").toString());
+        emit buildProgress(m_currentAsset, m_totalAssets, m_currentOperation);
     }
-
-    // Check for asset count progress
-    match = assetRegex.match(line);
-    if (match.hasMatch()) {
-        m_currentAsset = match.captured(1).toInt();
-        m_totalAssets = match.captured(2).toInt();
+    else if (type == "assetFinished" || type == "assetFailed") {
+        m_currentAsset++;
         emit buildProgress(m_currentAsset, m_totalAssets, m_currentOperation);
     }
+    else if (type == "streamDedup") {
+        emit buildOutput(QString("Reused %1 bytes of streaming data in \"%2\" for %3")
+            .arg(event.value("size").toInteger())
+            .arg(event.value("streamFile").toString(), event.value("asset").toString()));
+    }
+    else if (type == "compressProgress") {
+        const int percent = event.value("percent").toInt();
+        m_currentOperation = QString("Compressing... %1%").arg(percent);
+        emit buildProgress(percent, 100, m_currentOperation);
+    }
+    else if (type == "warning" || type == "error") {
+        const QString asset = event.value("asset").toString();
+        QString message = event.value("message").toString().trimmed();
+
+        if (!asset.isEmpty()) {
+            message = QString("%1: %2").arg(asset, message);
+        }
+
+        if (type == "error") {
+            m_errorCount++;
+            emit buildError(message);
+        } else {
+            m_warningCount++;
+            emit buildWarning(message);
+        }
+    }
 }
@@ -4,6 +4,7 @@
 #include <QObject>
 #include <QProcess>
 #include <QElapsedTimer>
+#include <QJsonObject>
 
 class Project;
 
@@ -66,17 +67,20 @@ signals:
 
 private slots:
     void onProcessReadyRead();
+    void onProcessEventsReadyRead();
     void onProcessError(QProcess::ProcessError error);
     void onProcessFinished(int exitCode, QProcess::ExitStatus exitStatus);
 
 private:
     void setStatus(BuildStatus status);
-    void parseOutput(const QString& line);
+    void startProcess(const QString& repakPath, QStringList args);
+    void handleEvent(const QJsonObject& event);
 
 private:
     QProcess* m_process;
     BuildStatus m_status;
     QElapsedTimer m_timer;
+    QByteArray m_eventBuffer; // Incomplete event line, completed by the next read.
 
     QString m_outputPath;
     QString m_currentOperation;
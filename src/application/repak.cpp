@@ -5,6 +5,7 @@
 #include "logic/streamfile.h"
 #include "logic/streamcache.h"
 #include "utils/zstdutils.h"
+#include "utils/buildevents.h"
 
 #define REPAK_DEFAULT_COMPRESS_LEVEL 6
 #define REPAK_DEFAULT_COMPRESS_WORKERS 16
@@ -13,11 +14,33 @@
 #define REPAK_STR_TO_UIMG_HASH_COMMAND "-uimghash"
 #define REPAK_COMPRESS_PAK_COMMAND "-compress"
 #define REPAK_DECOMPRESS_PAK_COMMAND "-decompress"
+#define REPAK_COMPRESS_PAK_IN_PLACE_COMMAND "-compressinplace"
+#define REPAK_DECOMPRESS_PAK_IN_PLACE_COMMAND "-decompressinplace"
+#define REPAK_BENCH_WRITE_COMMAND "-benchwrite"
+#define REPAK_BENCH_COMPRESS_COMMAND "-benchcompress"
+#define REPAK_TRAIN_DICT_COMMAND "-traindict"
+
+// Options that can be combined with any of the commands above.
+#define REPAK_EVENTS_OPTION "--events="
+#define REPAK_EVENTS_OUT_OPTION "--events-out="
+#define REPAK_KEEP_GOING_OPTION "--keep-going"
+
+#define REPAK_DEFAULT_BENCH_WRITE_SIZE_MB 256
+
+#define REPAK_DEFAULT_TRAIN_DICT_SIZE_KB 112 // zstd's recommended dictionary size.
+#define REPAK_TRAIN_DICT_SAMPLE_SIZE (64 * 1024)
+#define REPAK_TRAIN_DICT_MAX_SAMPLES_SIZE (512ull * 1024 * 1024)
+
+// Set by REPAK_KEEP_GOING_OPTION, see PF_KEEP_GOING.
+static bool s_keepGoing = false;
 
 static void RePak_InitBuilder(const js::Document& doc, const char* const mapPath, CBuildSettings& settings, CStreamFileBuilder& streamBuilder)
 {
     settings.Init(doc, mapPath);
 
+    if (s_keepGoing)
+        settings.AddFlags(PF_KEEP_GOING);
+
     const bool keepClient = settings.IsFlagSet(PF_KEEP_CLIENT);
 
     // Server-only paks never uses streaming assets.
@@ -52,7 +75,12 @@ static void RePak_BuildSingle(const js::Document& doc, const char* const mapPath
     CPakFileBuilder pakFile(&settings, &streamBuilder);
     pakFile.BuildFromMap(doc);
 
+    // the stream files must be finished before exiting on asset errors, as
+    // they wouldn't be readable otherwise.
     RePak_ShutdownBuilder(settings, streamBuilder);
+
+    if (pakFile.GetAssetErrorCount())
+        Error("Pak file failed to build with %zu asset errors.\n", pakFile.GetAssetErrorCount());
 }
 
 static void RePak_BuildFromList(const js::Document& doc, const js::Value& list, const char* const mapPath)
@@ -70,6 +98,9 @@ static void RePak_BuildFromList(const js::Document& doc, const js::Value& list,
 
     ssize_t i = -1;
 
+    size_t numFailedPaks = 0;
+    size_t numAssetErrors = 0;
+
     for (const js::Value& pak : list.GetArray())
     {
         i++;
@@ -85,9 +116,22 @@ static void RePak_BuildFromList(const js::Document& doc, const js::Value& list,
 
         CPakFileBuilder pakFile(&settings, &streamBuilder);
         pakFile.BuildFromMap(pakDoc);
+
+        // only happens with PF_KEEP_GOING, carry on to report the errors of
+        // the other paks as well.
+        if (pakFile.GetAssetErrorCount())
+        {
+            numFailedPaks++;
+            numAssetErrors += pakFile.GetAssetErrorCount();
+        }
     }
 
+    // the stream files are shared with the paks that did build, so they must
+    // be finished before exiting on asset errors.
     RePak_ShutdownBuilder(settings, streamBuilder);
+
+    if (numFailedPaks)
+        Error("%zu pak files failed to build with %zu asset errors.\n", numFailedPaks, numAssetErrors);
 }
 
 static void RePak_HandleBuild(const char* const arg)
@@ -116,6 +160,11 @@ static void RePak_HandleBuild(const char* const arg)
             RePak_BuildFromList(doc, paksIt->value, arg);
         else
             RePak_BuildSingle(doc, arg);
+
+        const JSONDocumentCacheStats_s& jsonStats = JSON_GetDocumentCacheStats();
+
+        Log("*** json document cache: parsed %zu files, %zu missing, %zu requests served from cache.\n",
+            jsonStats.numParsed, jsonStats.numMissing, jsonStats.numHits);
     }
 }
 
@@ -139,9 +188,37 @@ static void RePak_ExplainUsage()
         "\t<%s>\t- the target pak file to compress\n"
         "\t<%s>\t- ( optional ) the level of compression [ %d, %d ]; default = %d\n"
         "\t<%s>\t- ( optional ) the number of compression workers [ %d, %d ]; default = %d\n"
-
-        "For decompressing standalone paks, run 'repak %s' with the following parameter:\n"
-        "\t<%s>\t- the target pak file to decompress\n",
+        "\t<%s>\t- ( optional ) the size in MB of each independently decodable frame, 0 for a single frame; default = %d\n"
+        "\t<%s>\t- ( optional ) the window log [ %d, %d ], 0 to derive it from the level; default = %d\n"
+        "\t<%s>\t- ( optional ) 1 to enable long distance matching; default = %d\n"
+        "\t<%s>\t- ( optional ) the strategy [ %d, %d ], 0 to derive it from the level; default = %d\n"
+        "\t<%s>\t- ( optional ) the size in MB of each compression job, 0 to derive it from the parameters; default = %d\n"
+        "\t<%s>\t- ( optional ) the zstd dictionary to compress with, the runtime needs the same dictionary to load the pak\n"
+
+        "For decompressing standalone paks, run 'repak %s' with the following parameters:\n"
+        "\t<%s>\t- the target pak file to decompress\n"
+        "\t<%s>\t- ( optional ) the zstd dictionary the pak was compressed with\n"
+
+        "For compressing or decompressing standalone paks without a temporary copy, run 'repak %s' or 'repak %s' with the same parameters as above;\n"
+        "\tno scratch space is needed, but the pak file is left corrupt if the job fails halfway\n"
+
+        "For benchmarking file write throughput, run 'repak %s' with the following parameters:\n"
+        "\t<%s>\t- the temporary file to write to\n"
+        "\t<%s>\t- ( optional ) the amount of data to write in MB; default = %d\n"
+
+        "For benchmarking compression settings on a pak, run 'repak %s' with the following parameters:\n"
+        "\t<%s>\t- the pak file to benchmark, encoded or not; the file is not modified\n"
+        "\t<%s>\t- ( optional ) the zstd dictionary to benchmark with, required if the pak was compressed with it\n"
+
+        "For training a zstd dictionary on built paks, run 'repak %s' with the following parameters:\n"
+        "\t<%s>\t- the dictionary file to write\n"
+        "\t<%s>\t- a pak file, or a directory that is searched for pak files\n"
+        "\t<%s>\t- ( optional ) the maximum size of the dictionary in KB; default = %d\n"
+
+        "The following options can be passed before or after any of the above:\n"
+        "\t%s%s\t- write newline delimited JSON build events to stderr\n"
+        "\t%s<%s>\t- write the build events to given file or pipe instead\n"
+        "\t%s\t- report the errors of all assets instead of stopping at the first, no pak is written if any asset failed\n",
 
         "buildMapPath",
         "streamingPath",
@@ -156,8 +233,29 @@ static void RePak_ExplainUsage()
         "workerCount",
         1, ZSTDMT_NBWORKERS_MAX, REPAK_DEFAULT_COMPRESS_WORKERS,
 
+        "frameSize", 0,
+        "windowLog", ZSTD_WINDOWLOG_MIN, ZSTD_WINDOWLOG_LIMIT_DEFAULT, 0,
+        "longDistance", 0,
+        "strategy", ZSTD_fast, ZSTD_btultra2, 0,
+        "jobSize", 0,
+        "dictFilePath",
+
         REPAK_DECOMPRESS_PAK_COMMAND,
-        "pakFilePath"
+        "pakFilePath", "dictFilePath",
+
+        REPAK_COMPRESS_PAK_IN_PLACE_COMMAND, REPAK_DECOMPRESS_PAK_IN_PLACE_COMMAND,
+
+        REPAK_BENCH_WRITE_COMMAND, "filePath", "sizeInMB",
+        REPAK_DEFAULT_BENCH_WRITE_SIZE_MB,
+
+        REPAK_BENCH_COMPRESS_COMMAND, "pakFilePath", "dictFilePath",
+
+        REPAK_TRAIN_DICT_COMMAND, "dictFilePath", "corpusPath", "dictSizeInKB",
+        REPAK_DEFAULT_TRAIN_DICT_SIZE_KB,
+
+        REPAK_EVENTS_OPTION, "json",
+        REPAK_EVENTS_OUT_OPTION, "eventFilePath",
+        REPAK_KEEP_GOING_OPTION
     );
 }
 
@@ -185,9 +283,22 @@ static bool RePak_CheckCommandLine(const char* arg, const char* const target, co
     return false;
 }
 
-static uint16_t RePak_OpenPakAndValidateHeader(BinaryIO& bio, const char* const pakPath)
+static int RePak_GetOptionalIntArgument(const int argc, char** argv, const int index, const char* const argName, const int defaultValue)
 {
-    if (!bio.Open(pakPath, BinaryIO::Mode_e::ReadWrite))
+    if (argc <= index)
+        return defaultValue;
+
+    int value;
+
+    if (!JSON_StringToNumber(argv[index], strlen(argv[index]), value))
+        Error("%s: failed to parse %s for argument \"%s\".\n", __FUNCTION__, argName, argv[1]);
+
+    return value;
+}
+
+static uint16_t RePak_OpenPakAndValidateHeader(BinaryIO& bio, const char* const pakPath, const BinaryIO::Mode_e mode = BinaryIO::Mode_e::ReadWrite)
+{
+    if (!bio.Open(pakPath, mode))
         Error("Failed to open pak file \"%s\" for encode job.\n", pakPath);
 
     const std::streamoff size = bio.GetSize();
@@ -214,7 +325,7 @@ static uint16_t RePak_OpenPakAndValidateHeader(BinaryIO& bio, const char* const
     return version;
 }
 
-static void RePak_HandleCompressPak(const char* const pakPath, const int compressLevel, const int workerCount)
+static void RePak_HandleCompressPak(const char* const pakPath, const PakEncodeSettings_s& settings, const bool inPlace)
 {
     BinaryIO bio;
     const uint16_t version = RePak_OpenPakAndValidateHeader(bio, pakPath);
@@ -231,7 +342,7 @@ static void RePak_HandleCompressPak(const char* const pakPath, const int compres
     if (hdr->flags & (PAK_HEADER_FLAGS_RTECH_ENCODED | PAK_HEADER_FLAGS_OODLE_ENCODED | PAK_HEADER_FLAGS_ZSTD_ENCODED))
         Error("Pak file \"%s\" is already encoded using %s!\n", pakPath, Pak_EncodeAlgorithmToString(hdr->flags));
 
-    const size_t newSize = Pak_EncodeStreamAndSwap(bio, compressLevel, workerCount, version, pakPath);
+    const size_t newSize = Pak_EncodeStreamAndSwap(bio, settings, version, pakPath, inPlace);
 
     if (!newSize)
         return; // Failure, don't mutate the file.
@@ -245,7 +356,7 @@ static void RePak_HandleCompressPak(const char* const pakPath, const int compres
     bio.Write(tempHdrBuf, headerSize);
 }
 
-static void RePak_HandleDecompressPak(const char* const pakPath)
+static void RePak_HandleDecompressPak(const char* const pakPath, const char* const dictPath, const bool inPlace)
 {
     BinaryIO bio;
     const uint16_t version = RePak_OpenPakAndValidateHeader(bio, pakPath);
@@ -266,7 +377,7 @@ static void RePak_HandleDecompressPak(const char* const pakPath)
     if (!(hdr->flags & PAK_HEADER_FLAGS_ZSTD_ENCODED))
         Error("Pak file \"%s\" is already decoded!\n", pakPath);
 
-    const size_t newSize = Pak_DecodeStreamAndSwap(bio, version, pakPath);
+    const size_t newSize = Pak_DecodeStreamAndSwap(bio, version, pakPath, dictPath, inPlace);
 
     if (!newSize)
         return; // Failure, don't mutate the file.
@@ -293,8 +404,502 @@ static void RePak_HandleDecompressPak(const char* const pakPath)
     bio.Write(tempHdrBuf, headerSize);
 }
 
-static void RePak_HandleCommandLine(const int argc, char** argv)
+//-----------------------------------------------------------------------------
+// Purpose: writes the file through a plain std::fstream and through BinaryIO
+//          using small header sized writes, and reports the throughput of both
+//-----------------------------------------------------------------------------
+static double RePak_BenchmarkWrites(const char* const filePath, const size_t totalSize, const bool useBinaryIO)
+{
+    // mimic the asset descriptors; mostly 4 and 8 byte fields.
+    const uint64_t fields[4] = { 0x1122334455667788, 0x99AABBCCDDEEFF00, 0x0123456789ABCDEF, 0xFEDCBA9876543210 };
+    const size_t fieldSizes[4] = { 8, 4, 8, 4 };
+
+    const steady_clock::time_point start = high_resolution_clock::now();
+    size_t written = 0;
+
+    if (useBinaryIO)
+    {
+        BinaryIO out;
+
+        if (!out.Open(filePath, BinaryIO::Mode_e::Write))
+            Error("Failed to open file \"%s\" for write benchmark.\n", filePath);
+
+        for (size_t i = 0; written < totalSize; i++)
+        {
+            out.Write(&fields[i & 3], fieldSizes[i & 3]);
+            written += fieldSizes[i & 3];
+        }
+
+        out.Close();
+    }
+    else
+    {
+        std::fstream out(filePath, std::ios::out | std::ios::binary | std::ios::trunc);
+
+        if (!out.is_open())
+            Error("Failed to open file \"%s\" for write benchmark.\n", filePath);
+
+        for (size_t i = 0; written < totalSize; i++)
+        {
+            out.write(reinterpret_cast<const char*>(&fields[i & 3]), fieldSizes[i & 3]);
+            written += fieldSizes[i & 3];
+        }
+
+        out.close();
+    }
+
+    const steady_clock::time_point stop = high_resolution_clock::now();
+    const double seconds = duration_cast<microseconds>(stop - start).count() / 1000000.0;
+
+    return seconds > 0.0 ? (written / (1024.0 * 1024.0)) / seconds : 0.0;
+}
+
+static void RePak_HandleBenchmarkWrites(const char* const filePath, const int sizeInMB)
+{
+    if (sizeInMB <= 0)
+        Error("%s: invalid benchmark size of %d MB.\n", __FUNCTION__, sizeInMB);
+
+    const size_t totalSize = static_cast<size_t>(sizeInMB) * 1024 * 1024;
+
+    Log("*** benchmarking writes of %d MB to \"%s\".\n", sizeInMB, filePath);
+
+    const double streamThroughput = RePak_BenchmarkWrites(filePath, totalSize, false);
+    const double binaryIOThroughput = RePak_BenchmarkWrites(filePath, totalSize, true);
+
+    std::error_code ec;
+    fs::remove(filePath, ec);
+
+    Log("std::fstream: %.1f MB/s.\n", streamThroughput);
+    Log("BinaryIO:     %.1f MB/s (%.2fx).\n", binaryIOThroughput,
+        streamThroughput > 0.0 ? binaryIOThroughput / streamThroughput : 0.0);
+}
+
+struct RePakCompressBenchConfig_s
+{
+    int compressLevel;
+    int workerCount;
+    int windowLog; // 0 = derived from the compression level.
+    bool longDistance;
+};
+
+//-----------------------------------------------------------------------------
+// Purpose: compresses and decompresses the data in memory with given settings
+//          and reports the ratio and throughput of both
+//-----------------------------------------------------------------------------
+static void RePak_BenchmarkCompressConfig(const RePakCompressBenchConfig_s& config, const uint8_t* const data, const size_t dataSize, const std::vector<uint8_t>& dict,
+    ZSTDEncoder_s& encoder, ZSTDDecoder_s& decoder, uint8_t* const encodeBuf, const size_t encodeBufSize, uint8_t* const decodeBuf)
+{
+    ZSTD_CCtx* const cctx = &encoder.cctx;
+    ZSTD_CCtx_reset(cctx, ZSTD_reset_session_and_parameters);
+
+    // An empty dictionary clears the one loaded for the previous config.
+    size_t result = ZSTD_CCtx_loadDictionary(cctx, dict.data(), dict.size());
+
+    if (!ZSTD_isError(result))
+        result = ZSTD_CCtx_setParameter(cctx, ZSTD_c_compressionLevel, config.compressLevel);
+
+    if (!ZSTD_isError(result))
+        result = ZSTD_CCtx_setParameter(cctx, ZSTD_c_nbWorkers, config.workerCount);
+
+    if (!ZSTD_isError(result))
+        result = ZSTD_CCtx_setParameter(cctx, ZSTD_c_windowLog, config.windowLog);
+
+    if (!ZSTD_isError(result))
+        result = ZSTD_CCtx_setParameter(cctx, ZSTD_c_enableLongDistanceMatching, config.longDistance ? ZSTD_ps_enable : ZSTD_ps_disable);
+
+    if (ZSTD_isError(result))
+    {
+        Warning("%s: failed to apply settings for level %d: [%s].\n", __FUNCTION__, config.compressLevel, ZSTD_getErrorName(result));
+        return;
+    }
+
+    const steady_clock::time_point encodeStart = high_resolution_clock::now();
+    const size_t encodedSize = ZSTD_compress2(cctx, encodeBuf, encodeBufSize, data, dataSize);
+    const steady_clock::time_point encodeStop = high_resolution_clock::now();
+
+    if (ZSTD_isError(encodedSize))
+    {
+        Warning("%s: failed to compress at level %d: [%s].\n", __FUNCTION__, config.compressLevel, ZSTD_getErrorName(encodedSize));
+        return;
+    }
+
+    ZSTD_DCtx* const dctx = &decoder.dctx;
+    ZSTD_DCtx_reset(dctx, ZSTD_reset_session_only);
+    ZSTD_DCtx_loadDictionary(dctx, dict.data(), dict.size());
+
+    const steady_clock::time_point decodeStart = high_resolution_clock::now();
+    const size_t decodedSize = ZSTD_decompressDCtx(dctx, decodeBuf, dataSize, encodeBuf, encodedSize);
+    const steady_clock::time_point decodeStop = high_resolution_clock::now();
+
+    if (ZSTD_isError(decodedSize) || decodedSize != dataSize || memcmp(decodeBuf, data, dataSize) != 0)
+    {
+        Warning("%s: round trip failed at level %d.\n", __FUNCTION__, config.compressLevel);
+        return;
+    }
+
+    const double dataSizeInMB = dataSize / (1024.0 * 1024.0);
+    const double encodeSeconds = duration_cast<microseconds>(encodeStop - encodeStart).count() / 1000000.0;
+    const double decodeSeconds = duration_cast<microseconds>(decodeStop - decodeStart).count() / 1000000.0;
+
+    Log("%6d %8d %6d %4s %8.3f %12.1f %12.1f\n",
+        config.compressLevel, config.workerCount, config.windowLog, config.longDistance ? "on" : "off",
+        static_cast<double>(dataSize) / encodedSize,
+        encodeSeconds > 0.0 ? dataSizeInMB / encodeSeconds : 0.0,
+        decodeSeconds > 0.0 ? dataSizeInMB / decodeSeconds : 0.0);
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: returns the size of the data past the header of a pak once decoded
+//-----------------------------------------------------------------------------
+static size_t RePak_GetPakDataSize(const char* const pakPath)
+{
+    BinaryIO bio;
+    const uint16_t version = RePak_OpenPakAndValidateHeader(bio, pakPath, BinaryIO::Mode_e::Read);
+
+    // Largest header is 128 bytes (v8).
+    char tempHdrBuf[128];
+    bio.Seek(0);
+
+    const size_t headerSize = Pak_GetHeaderSize(version);
+    bio.Read(tempHdrBuf, headerSize);
+
+    const PakHdr_t* const hdr = (PakHdr_t*)tempHdrBuf;
+
+    if (!(hdr->flags & PAK_HEADER_FLAGS_ZSTD_ENCODED))
+        return static_cast<size_t>(bio.GetSize()) - headerSize;
+
+    // The field's offset differs per version, so it can't be read through hdr.
+    const size_t decompressedSize = Pak_ReadHeaderDecompressedSize(bio, version);
+    return decompressedSize > headerSize ? decompressedSize - headerSize : 0;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: loads the data past the header of a pak in memory, decoding it if
+//          the pak is zstd encoded
+// Input  : *pakPath -
+//          &dict - the dictionary the pak was compressed with, can be empty
+//          &outData -
+//-----------------------------------------------------------------------------
+static size_t RePak_LoadPakData(const char* const pakPath, const std::vector<uint8_t>& dict, std::unique_ptr<uint8_t[]>& outData)
+{
+    BinaryIO bio;
+    const uint16_t version = RePak_OpenPakAndValidateHeader(bio, pakPath, BinaryIO::Mode_e::Read);
+
+    // Largest header is 128 bytes (v8).
+    char tempHdrBuf[128];
+    bio.Seek(0);
+
+    const size_t headerSize = Pak_GetHeaderSize(version);
+    bio.Read(tempHdrBuf, headerSize);
+
+    const PakHdr_t* const hdr = (PakHdr_t*)tempHdrBuf;
+
+    if (hdr->flags & (PAK_HEADER_FLAGS_RTECH_ENCODED | PAK_HEADER_FLAGS_OODLE_ENCODED))
+        Error("Pak file \"%s\" is encoded using %s which is unsupported!\n", pakPath, Pak_EncodeAlgorithmToString(hdr->flags));
+
+    // The field's offset differs per version, so it can't be read through hdr.
+    const size_t decompressedSize = Pak_ReadHeaderDecompressedSize(bio, version);
+
+    const size_t fileDataSize = static_cast<size_t>(bio.GetSize()) - headerSize;
+    std::unique_ptr<uint8_t[]> fileData(new uint8_t[fileDataSize]);
+
+    bio.SeekGet(headerSize);
+    bio.Read(fileData.get(), fileDataSize);
+    bio.Close();
+
+    if (!(hdr->flags & PAK_HEADER_FLAGS_ZSTD_ENCODED))
+    {
+        outData = std::move(fileData);
+        return fileDataSize;
+    }
+
+    if (decompressedSize < headerSize)
+        Error("Pak file \"%s\" has an invalid decompressed size of %zu!\n", pakPath, decompressedSize);
+
+    const size_t dataSize = decompressedSize - headerSize;
+    outData.reset(new uint8_t[dataSize]);
+
+    const unsigned int frameDictID = ZSTD_getDictID_fromFrame(fileData.get(), fileDataSize);
+
+    if (frameDictID != 0 && frameDictID != ZDICT_getDictID(dict.data(), dict.size()))
+    {
+        Error("Pak file \"%s\" was compressed with dictionary %u, which is needed to decode it.\n",
+            pakPath, frameDictID);
+    }
+
+    ZSTDDecoder_s decoder;
+    ZSTD_DCtx_loadDictionary(&decoder.dctx, dict.data(), dict.size());
+
+    // Decodes all frames, the seek table of seekable paks is skipped.
+    const size_t decodedSize = ZSTD_decompressDCtx(&decoder.dctx, outData.get(), dataSize, fileData.get(), fileDataSize);
+
+    if (ZSTD_isError(decodedSize) || decodedSize != dataSize)
+    {
+        Error("Failed to decode pak file \"%s\": [%s].\n", pakPath,
+            ZSTD_isError(decodedSize) ? ZSTD_getErrorName(decodedSize) : "size mismatch");
+    }
+
+    return dataSize;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: loads the pak data in memory once, decoding it if necessary, and
+//          benchmarks the compression levels, worker counts and window and
+//          long distance matching settings on it
+//-----------------------------------------------------------------------------
+static void RePak_HandleBenchmarkCompress(const char* const pakPath, const char* const dictPath)
+{
+    // Decodes the pak if it was compressed with the dictionary, and measures
+    // every config with it.
+    std::vector<uint8_t> dict;
+
+    if (dictPath)
+        Pak_LoadCompressDictionary(dictPath, dict);
+
+    std::unique_ptr<uint8_t[]> data;
+    const size_t dataSize = RePak_LoadPakData(pakPath, dict, data);
+
+    if (!dataSize)
+        Error("Pak file \"%s\" has no data to benchmark!\n", pakPath);
+
+    ZSTDEncoder_s encoder;
+    ZSTDDecoder_s decoder;
+
+    const size_t encodeBufSize = ZSTD_compressBound(dataSize);
+    std::unique_ptr<uint8_t[]> encodeBuf(new uint8_t[encodeBufSize]);
+    std::unique_ptr<uint8_t[]> decodeBuf(new uint8_t[dataSize]);
+
+    std::vector<RePakCompressBenchConfig_s> configs;
+
+    // Compression levels; see https://github.com/facebook/zstd/issues/3032
+    // for the lower bound.
+    for (int level = -5; level <= ZSTD_maxCLevel(); level++)
+    {
+        if (level != 0) // Level 0 maps to ZSTD_CLEVEL_DEFAULT.
+            configs.push_back({ level, REPAK_DEFAULT_COMPRESS_WORKERS, 0, false });
+    }
+
+    // Worker counts, at the default level.
+    for (int workerCount = 1; workerCount <= ZSTDMT_NBWORKERS_MAX; workerCount *= 2)
+    {
+        if (workerCount != REPAK_DEFAULT_COMPRESS_WORKERS)
+            configs.push_back({ REPAK_DEFAULT_COMPRESS_LEVEL, workerCount, 0, false });
+    }
+
+    // Window sizes and long distance matching, at the default level; windows
+    // past the default decoder limit cannot be loaded by the runtime.
+    for (int windowLog = 20; windowLog <= ZSTD_WINDOWLOG_LIMIT_DEFAULT; windowLog++)
+    {
+        configs.push_back({ REPAK_DEFAULT_COMPRESS_LEVEL, REPAK_DEFAULT_COMPRESS_WORKERS, windowLog, false });
+        configs.push_back({ REPAK_DEFAULT_COMPRESS_LEVEL, REPAK_DEFAULT_COMPRESS_WORKERS, windowLog, true });
+    }
+
+    Log("*** benchmarking %zu compression settings on %.1f MB of pak data from \"%s\"%s.\n",
+        configs.size(), dataSize / (1024.0 * 1024.0), pakPath, dict.empty() ? "" : " with dictionary");
+
+    Log("%6s %8s %6s %4s %8s %12s %12s\n", "level", "workers", "window", "ldm", "ratio", "comp MB/s", "decomp MB/s");
+
+    for (const RePakCompressBenchConfig_s& config : configs)
+        RePak_BenchmarkCompressConfig(config, data.get(), dataSize, dict, encoder, decoder, encodeBuf.get(), encodeBufSize, decodeBuf.get());
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: collects the rpak files to train a dictionary on, the corpus path
+//          is either a single pak or a directory that is searched recursively
+//-----------------------------------------------------------------------------
+static void RePak_GatherTrainingPaks(const char* const corpusPath, std::vector<std::string>& outPaks)
+{
+    if (!fs::is_directory(corpusPath))
+    {
+        outPaks.emplace_back(corpusPath);
+        return;
+    }
+
+    for (const fs::directory_entry& entry : fs::recursive_directory_iterator(corpusPath))
+    {
+        if (entry.is_regular_file() && entry.path().extension() == ".rpak")
+            outPaks.emplace_back(entry.path().string());
+    }
+
+    // Keep the sampling deterministic between runs.
+    std::sort(outPaks.begin(), outPaks.end());
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: compresses the data with and without the dictionary at the default
+//          level and returns the compressed sizes
+//-----------------------------------------------------------------------------
+static void RePak_CompressWithDictionary(ZSTDEncoder_s& encoder, const uint8_t* const data, const size_t dataSize,
+    const std::vector<uint8_t>& dict, std::vector<uint8_t>& encodeBuf, size_t& outPlainSize, size_t& outDictSize)
+{
+    ZSTD_CCtx* const cctx = &encoder.cctx;
+    encodeBuf.resize(ZSTD_compressBound(dataSize));
+
+    ZSTD_CCtx_reset(cctx, ZSTD_reset_session_and_parameters);
+    ZSTD_CCtx_setParameter(cctx, ZSTD_c_compressionLevel, REPAK_DEFAULT_COMPRESS_LEVEL);
+
+    outPlainSize = ZSTD_compress2(cctx, encodeBuf.data(), encodeBuf.size(), data, dataSize);
+
+    ZSTD_CCtx_loadDictionary(cctx, dict.data(), dict.size());
+    outDictSize = ZSTD_compress2(cctx, encodeBuf.data(), encodeBuf.size(), data, dataSize);
+
+    if (ZSTD_isError(outPlainSize) || ZSTD_isError(outDictSize))
+        Error("%s: failed to compress pak data: [%s].\n", __FUNCTION__, ZSTD_getErrorName(ZSTD_isError(outPlainSize) ? outPlainSize : outDictSize));
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: trains a zstd dictionary on samples of the data of the paks in the
+//          corpus, and reports the ratio of each pak with and without it
+//-----------------------------------------------------------------------------
+static void RePak_HandleTrainDictionary(const char* const dictPath, const char* const corpusPath, const int dictSizeInKB)
+{
+    if (dictSizeInKB <= 0)
+        Error("%s: invalid dictionary size of %d KB.\n", __FUNCTION__, dictSizeInKB);
+
+    std::vector<std::string> paks;
+    RePak_GatherTrainingPaks(corpusPath, paks);
+
+    if (paks.empty())
+        Error("No pak files found in \"%s\" to train a dictionary on.\n", corpusPath);
+
+    Log("*** training %d KB dictionary on %zu pak files from \"%s\".\n", dictSizeInKB, paks.size(), corpusPath);
+
+    // Split the data of each pak in fixed size samples; large corpora are
+    // sampled evenly so the samples stay within the training budget. Only
+    // one pak is held in memory at a time.
+    size_t totalDataSize = 0;
+
+    for (const std::string& pak : paks)
+        totalDataSize += RePak_GetPakDataSize(pak.c_str());
+
+    const size_t sampleStride = (std::max)(size_t(1), (totalDataSize + REPAK_TRAIN_DICT_MAX_SAMPLES_SIZE - 1) / REPAK_TRAIN_DICT_MAX_SAMPLES_SIZE);
+
+    std::vector<uint8_t> samples;
+    std::vector<size_t> sampleSizes;
+
+    size_t sampleIndex = 0;
+
+    for (const std::string& pak : paks)
+    {
+        std::unique_ptr<uint8_t[]> data;
+        const size_t dataSize = RePak_LoadPakData(pak.c_str(), {}, data);
+
+        for (size_t offset = 0; offset < dataSize; offset += REPAK_TRAIN_DICT_SAMPLE_SIZE)
+        {
+            if ((sampleIndex++ % sampleStride) != 0)
+                continue;
+
+            const size_t sampleSize = (std::min)(size_t(REPAK_TRAIN_DICT_SAMPLE_SIZE), dataSize - offset);
+
+            samples.insert(samples.end(), &data[offset], &data[offset] + sampleSize);
+            sampleSizes.push_back(sampleSize);
+        }
+    }
+
+    std::vector<uint8_t> dict(static_cast<size_t>(dictSizeInKB) * 1024);
+
+    const steady_clock::time_point start = high_resolution_clock::now();
+    const size_t dictSize = ZDICT_trainFromBuffer(dict.data(), dict.size(), samples.data(), sampleSizes.data(), static_cast<unsigned int>(sampleSizes.size()));
+    const steady_clock::time_point stop = high_resolution_clock::now();
+
+    if (ZDICT_isError(dictSize))
+        Error("Failed to train dictionary on %zu samples: [%s].\n", sampleSizes.size(), ZDICT_getErrorName(dictSize));
+
+    dict.resize(dictSize);
+
+    BinaryIO dictFile;
+
+    if (!dictFile.Open(dictPath, BinaryIO::Mode_e::Write))
+        Error("Failed to open dictionary file \"%s\" for write.\n", dictPath);
+
+    dictFile.Write(dict.data(), dict.size());
+    dictFile.Close();
+
+    Log("*** trained dictionary %u of %zu bytes on %zu samples ( %.1f MB ); took %lld ms.\n",
+        ZDICT_getDictID(dict.data(), dict.size()), dictSize, sampleSizes.size(), samples.size() / (1024.0 * 1024.0),
+        duration_cast<milliseconds>(stop - start).count());
+
+    // The paks were part of the training set, so these ratios are an upper
+    // bound for paks built from similar assets.
+    Log("%10s %10s %8s %10s %8s  %s\n", "size", "plain", "ratio", "dict", "ratio", "pak");
+
+    ZSTDEncoder_s encoder;
+    std::vector<uint8_t> encodeBuf;
+
+    size_t totalPlainSize = 0;
+    size_t totalDictSize = 0;
+
+    for (const std::string& pak : paks)
+    {
+        std::unique_ptr<uint8_t[]> data;
+        const size_t dataSize = RePak_LoadPakData(pak.c_str(), {}, data);
+
+        if (!dataSize)
+            continue;
+
+        size_t plainSize, withDictSize;
+        RePak_CompressWithDictionary(encoder, data.get(), dataSize, dict, encodeBuf, plainSize, withDictSize);
+
+        totalPlainSize += plainSize;
+        totalDictSize += withDictSize;
+
+        Log("%10zu %10zu %8.3f %10zu %8.3f  %s\n", dataSize,
+            plainSize, static_cast<double>(dataSize) / plainSize,
+            withDictSize, static_cast<double>(dataSize) / withDictSize, pak.c_str());
+    }
+
+    if (totalPlainSize && totalDictSize)
+    {
+        Log("%10zu %10zu %8.3f %10zu %8.3f  %s\n", totalDataSize,
+            totalPlainSize, static_cast<double>(totalDataSize) / totalPlainSize,
+            totalDictSize, static_cast<double>(totalDataSize) / totalDictSize, "( total )");
+    }
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: handles the '--' options and removes them from the arguments, so
+//          the commands see their parameters at the usual positions
+//-----------------------------------------------------------------------------
+static void RePak_HandleCommandLineOptions(int& argc, char** argv)
 {
+    const char* eventsFormat = nullptr;
+    const char* eventsOutPath = nullptr;
+
+    int numArgs = 0;
+
+    for (int i = 0; i < argc; i++)
+    {
+        const char* const arg = argv[i];
+
+        if (strncmp(arg, REPAK_EVENTS_OPTION, sizeof(REPAK_EVENTS_OPTION) - 1) == 0)
+            eventsFormat = &arg[sizeof(REPAK_EVENTS_OPTION) - 1];
+        else if (strncmp(arg, REPAK_EVENTS_OUT_OPTION, sizeof(REPAK_EVENTS_OUT_OPTION) - 1) == 0)
+            eventsOutPath = &arg[sizeof(REPAK_EVENTS_OUT_OPTION) - 1];
+        else if (strcmp(arg, REPAK_KEEP_GOING_OPTION) == 0)
+            s_keepGoing = true;
+        else
+            argv[numArgs++] = argv[i];
+    }
+
+    argc = numArgs;
+
+    if (eventsOutPath && !eventsFormat)
+        eventsFormat = "json"; // The only format, implied by the output path.
+
+    if (!eventsFormat)
+        return;
+
+    if (strcmp(eventsFormat, "json") != 0)
+        Error("Unsupported build event format \"%s\"; only \"json\" is supported.\n", eventsFormat);
+
+    if (!BuildEvents_Init(eventsOutPath))
+        Error("Failed to open build event output \"%s\".\n", eventsOutPath);
+}
+
+static void RePak_HandleCommandLine(int argc, char** argv)
+{
+    RePak_HandleCommandLineOptions(argc, argv);
+
     if (argc < 2)
     {
         RePak_ExplainUsage();
@@ -317,25 +922,52 @@ static void RePak_HandleCommandLine(const int argc, char** argv)
         return;
     }
 
-    if (RePak_CheckCommandLine(argv[1], REPAK_COMPRESS_PAK_COMMAND, argc, 3))
+    if (RePak_CheckCommandLine(argv[1], REPAK_COMPRESS_PAK_COMMAND, argc, 3) ||
+        RePak_CheckCommandLine(argv[1], REPAK_COMPRESS_PAK_IN_PLACE_COMMAND, argc, 3))
     {
-        int compressLevel = REPAK_DEFAULT_COMPRESS_LEVEL;
+        PakEncodeSettings_s settings;
+
+        settings.compressLevel = RePak_GetOptionalIntArgument(argc, argv, 3, "compressLevel", REPAK_DEFAULT_COMPRESS_LEVEL);
+        settings.workerCount = RePak_GetOptionalIntArgument(argc, argv, 4, "workerCount", REPAK_DEFAULT_COMPRESS_WORKERS);
+        settings.frameSize = Pak_GetCompressFrameSize(RePak_GetOptionalIntArgument(argc, argv, 5, "frameSize", 0));
+        settings.windowLog = RePak_GetOptionalIntArgument(argc, argv, 6, "windowLog", 0);
+        settings.longDistance = RePak_GetOptionalIntArgument(argc, argv, 7, "longDistance", 0) != 0;
+        settings.strategy = RePak_GetOptionalIntArgument(argc, argv, 8, "strategy", 0);
+        settings.jobSize = Pak_GetCompressJobSize(RePak_GetOptionalIntArgument(argc, argv, 9, "jobSize", 0));
+
+        if (argc > 10)
+            settings.dictPath = argv[10];
 
-        if ((argc > 3) && (!JSON_StringToNumber(argv[3], strlen(argv[3]), compressLevel)))
-            Error("%s: failed to parse compressLevel for argument \"%s\".\n", __FUNCTION__, argv[1]);
+        Pak_ValidateEncodeSettings(settings);
+
+        RePak_HandleCompressPak(argv[2], settings, strcmp(argv[1], REPAK_COMPRESS_PAK_IN_PLACE_COMMAND) == 0);
+        return;
+    }
 
-        int workerCount = REPAK_DEFAULT_COMPRESS_WORKERS;
+    if (RePak_CheckCommandLine(argv[1], REPAK_DECOMPRESS_PAK_COMMAND, argc, 3) ||
+        RePak_CheckCommandLine(argv[1], REPAK_DECOMPRESS_PAK_IN_PLACE_COMMAND, argc, 3))
+    {
+        RePak_HandleDecompressPak(argv[2], argc > 3 ? argv[3] : nullptr, strcmp(argv[1], REPAK_DECOMPRESS_PAK_IN_PLACE_COMMAND) == 0);
+        return;
+    }
 
-        if ((argc > 4) && (!JSON_StringToNumber(argv[4], strlen(argv[4]), workerCount)))
-            Error("%s: failed to parse workerCount for argument \"%s\".\n", __FUNCTION__, argv[1]);
+    if (RePak_CheckCommandLine(argv[1], REPAK_BENCH_WRITE_COMMAND, argc, 3))
+    {
+        const int sizeInMB = RePak_GetOptionalIntArgument(argc, argv, 3, "sizeInMB", REPAK_DEFAULT_BENCH_WRITE_SIZE_MB);
+        RePak_HandleBenchmarkWrites(argv[2], sizeInMB);
+        return;
+    }
 
-        RePak_HandleCompressPak(argv[2], compressLevel, workerCount);
+    if (RePak_CheckCommandLine(argv[1], REPAK_BENCH_COMPRESS_COMMAND, argc, 3))
+    {
+        RePak_HandleBenchmarkCompress(argv[2], argc > 3 ? argv[3] : nullptr);
         return;
     }
 
-    if (RePak_CheckCommandLine(argv[1], REPAK_DECOMPRESS_PAK_COMMAND, argc, 3))
+    if (RePak_CheckCommandLine(argv[1], REPAK_TRAIN_DICT_COMMAND, argc, 4))
     {
-        RePak_HandleDecompressPak(argv[2]);
+        const int dictSizeInKB = RePak_GetOptionalIntArgument(argc, argv, 4, "dictSizeInKB", REPAK_DEFAULT_TRAIN_DICT_SIZE_KB);
+        RePak_HandleTrainDictionary(argv[2], argv[3], dictSizeInKB);
         return;
     }
 
@@ -346,6 +978,7 @@ int main(int argc, char** argv)
 {
     extern bool Console_ColorInit();
     Console_ColorInit();
+    Logger_Init();
 
     g_jsonErrorCallback = Error;
 
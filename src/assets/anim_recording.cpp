@@ -2,17 +2,40 @@
 #include "assets.h"
 #include "public/anim_recording.h"
 
-static void AnimRecording_ParseFromANIR(const char* const assetPath, BinaryIO& bio, AnimRecordingFileHeader_s& hdr, size_t& totalBufSize)
+// Validates the null terminated strings at given offset, the offset is advanced
+// past the strings. Returns the number of bytes taken by the strings.
+static size_t AnimRecording_ValidateStrings(const char* const assetPath, const CMappedFile& file, size_t& offset, const int numStrings, const char* const stringType)
 {
-	if (!bio.Open(assetPath, BinaryIO::Mode_e::Read))
+	size_t totalStringBufLen = 0;
+
+	for (int i = 0; i < numStrings; i++)
+	{
+		const char* const string = file.GetData<char>(offset);
+		const char* const terminator = reinterpret_cast<const char*>(memchr(string, '\0', file.GetSize() - offset));
+
+		if (!terminator)
+			Error("Animation recording file \"%s\" appears truncated; failed to read %s name #%i.\n", assetPath, stringType, i);
+
+		const size_t stringBufLen = (terminator - string) + 1;
+
+		offset += stringBufLen;
+		totalStringBufLen += stringBufLen;
+	}
+
+	return totalStringBufLen;
+}
+
+static const AnimRecordingFileHeader_s* AnimRecording_ParseFromANIR(const char* const assetPath, CMappedFile& file, size_t& totalBufSize)
+{
+	if (!file.Open(assetPath))
 		Error("Failed to open animation recording file \"%s\".\n", assetPath);
 
-	const size_t fileSize = bio.GetSize();
+	const size_t fileSize = file.GetSize();
 
-	if (bio.GetSize() <= sizeof(AnimRecordingFileHeader_s))
+	if (fileSize <= sizeof(AnimRecordingFileHeader_s))
 		Error("Animation recording file \"%s\" appears truncated (%zu <= %zu).\n", assetPath, fileSize, sizeof(AnimRecordingFileHeader_s));
 
-	bio.Read(hdr);
+	const AnimRecordingFileHeader_s& hdr = *file.GetData<AnimRecordingFileHeader_s>();
 
 	if (hdr.magic != ANIR_FILE_MAGIC)
 		Error("Attempted to load an invalid animation recording file (expected magic %x, got %x).\n", ANIR_FILE_MAGIC, hdr.magic);
@@ -23,28 +46,53 @@ static void AnimRecording_ParseFromANIR(const char* const assetPath, BinaryIO& b
 	if (hdr.assetVersion != ANIR_VERSION)
 		Error("Attempted to load an unsupported animation recording file (expected asset version %x, got %x).\n", ANIR_VERSION, hdr.assetVersion);
 
-	if (hdr.numElements > ANIR_MAX_ELEMENTS)
-		Error("Animation recording file \"%s\" has too many elements (max %d, got %d).\n", assetPath, ANIR_MAX_ELEMENTS, hdr.numElements);
+	if (hdr.numElements < 0 || hdr.numElements > ANIR_MAX_ELEMENTS)
+		Error("Animation recording file \"%s\" has an invalid number of elements (max %d, got %d).\n", assetPath, ANIR_MAX_ELEMENTS, hdr.numElements);
 
-	if (hdr.numSequences > ANIR_MAX_SEQUENCES)
-		Error("Animation recording file \"%s\" has too many sequences (max %d, got %d).\n", assetPath, ANIR_MAX_SEQUENCES, hdr.numSequences);
+	if (hdr.numSequences < 0 || hdr.numSequences > ANIR_MAX_SEQUENCES)
+		Error("Animation recording file \"%s\" has an invalid number of sequences (max %d, got %d).\n", assetPath, ANIR_MAX_SEQUENCES, hdr.numSequences);
 
-	if (hdr.numRecordedFrames == 0)
-		Error("Animation recording file \"%s\" has 0 frames.\n", assetPath);
+	if (hdr.numRecordedFrames <= 0)
+		Error("Animation recording file \"%s\" has %d frames.\n", assetPath, hdr.numRecordedFrames);
 
 	if (hdr.numRecordedFrames > ANIR_MAX_RECORDED_FRAMES)
 		Error("Animation recording file \"%s\" has too many frames (max %d, got %d).\n", assetPath, ANIR_MAX_RECORDED_FRAMES, hdr.numRecordedFrames);
 
 	// NOTE: the overlay count can be 0, so only check for max here, which is equal to frames.
-	if (hdr.numRecordedOverlays > ANIR_MAX_RECORDED_FRAMES)
-		Error("Animation recording file \"%s\" has too many overlays (max %d, got %d).\n", assetPath, ANIR_MAX_RECORDED_FRAMES, hdr.numRecordedOverlays);
+	if (hdr.numRecordedOverlays < 0 || hdr.numRecordedOverlays > ANIR_MAX_RECORDED_FRAMES)
+		Error("Animation recording file \"%s\" has an invalid number of overlays (max %d, got %d).\n", assetPath, ANIR_MAX_RECORDED_FRAMES, hdr.numRecordedOverlays);
+
+	if (hdr.stringBufSize < 0)
+		Error("Animation recording file \"%s\" has an invalid string buffer size (%d).\n", assetPath, hdr.stringBufSize);
 
 	const size_t stringBufSize = IALIGN4(hdr.stringBufSize);
 
 	const size_t animFramesBufSize = hdr.numRecordedFrames * sizeof(AnimRecordingFrame_s);
 	const size_t animOverlaysBufSize = hdr.numRecordedOverlays * sizeof(AnimRecordingOverlay_s);
 
+	// Validate the entire file up front, so it can be copied without further
+	// checks. The layout is: pose parameter names, pose parameter values,
+	// sequence names, frames, then overlays.
+	size_t offset = sizeof(AnimRecordingFileHeader_s);
+	size_t totalStringBufLen = AnimRecording_ValidateStrings(assetPath, file, offset, hdr.numElements, "pose parameter");
+
+	offset += hdr.numElements * sizeof(Vector2);
+
+	if (offset > fileSize)
+		Error("Animation recording file \"%s\" appears truncated; failed to read pose parameter values.\n", assetPath);
+
+	totalStringBufLen += AnimRecording_ValidateStrings(assetPath, file, offset, hdr.numSequences, "animation sequence");
+
+	if (totalStringBufLen > static_cast<size_t>(hdr.stringBufSize))
+		Error("Animation recording file \"%s\" has %zu bytes of strings, but its string buffer size is %d.\n", assetPath, totalStringBufLen, hdr.stringBufSize);
+
+	const size_t expectedFileSize = offset + animFramesBufSize + animOverlaysBufSize;
+
+	if (fileSize < expectedFileSize)
+		Error("Animation recording file \"%s\" appears truncated (%zu < %zu).\n", assetPath, fileSize, expectedFileSize);
+
 	totalBufSize = stringBufSize + animFramesBufSize + animOverlaysBufSize;
+	return &hdr;
 }
 
 // page chunk structure and order:
@@ -54,10 +102,11 @@ static void AnimRecording_InternalAddAnimRecording(CPakFileBuilder* const pak, c
 {
 	const std::string anirPath = Utils::ChangeExtension(pak->GetAssetPath() + assetPath, "anir");
 
-	BinaryIO bio;
-	AnimRecordingFileHeader_s fileHdr; size_t cpuBufSize;
+	CMappedFile anirFile;
+	size_t cpuBufSize;
 
-	AnimRecording_ParseFromANIR(anirPath.c_str(), bio, fileHdr, cpuBufSize);
+	// The file has been fully validated after this call.
+	const AnimRecordingFileHeader_s& fileHdr = *AnimRecording_ParseFromANIR(anirPath.c_str(), anirFile, cpuBufSize);
 
 	PakAsset_t& asset = pak->BeginAsset(assetGuid, assetPath);
 
@@ -85,37 +134,35 @@ static void AnimRecording_InternalAddAnimRecording(CPakFileBuilder* const pak, c
 	size_t cpuBufIt = 0;
 	PakPageLump_s cpuLump = pak->CreatePageLump(cpuBufSize, SF_CPU | SF_SERVER, 4);
 
+	size_t fileOffset = sizeof(AnimRecordingFileHeader_s);
+
 	for (int i = 0; i < fileHdr.numElements; i++)
 	{
-		std::string poseParamName;
-
-		if (!bio.ReadString(poseParamName))
-			Error("Failed to read pose parameter name #%i\n", i);
+		const char* const poseParamName = anirFile.GetData<char>(fileOffset);
+		const size_t stringBufLen = strlen(poseParamName) + 1;
 
-		const size_t stringBufLen = poseParamName.length() + 1;
-		memcpy(&cpuLump.data[cpuBufIt], poseParamName.c_str(), stringBufLen);
+		memcpy(&cpuLump.data[cpuBufIt], poseParamName, stringBufLen);
 
 		pak->AddPointer(hdrLump, offsetof(AnimRecordingAssetHeader_s, poseParamNames) + i * sizeof(PagePtr_t), cpuLump, cpuBufIt);
 		cpuBufIt += stringBufLen;
+		fileOffset += stringBufLen;
 	}
 
-	for (int i = 0; i < fileHdr.numElements; i++)
-	{
-		bio.Read(pHdr->poseParamValues[i]);
-	}
+	const size_t poseParamValuesSize = fileHdr.numElements * sizeof(Vector2);
+
+	memcpy(pHdr->poseParamValues, anirFile.GetData<Vector2>(fileOffset), poseParamValuesSize);
+	fileOffset += poseParamValuesSize;
 
 	for (int i = 0; i < fileHdr.numSequences; i++)
 	{
-		std::string sequenceName;
-
-		if (!bio.ReadString(sequenceName))
-			Error("Failed to read animation sequence name #%i\n", i);
+		const char* const sequenceName = anirFile.GetData<char>(fileOffset);
+		const size_t stringBufLen = strlen(sequenceName) + 1;
 
-		const size_t stringBufLen = sequenceName.length() + 1;
-		memcpy(&cpuLump.data[cpuBufIt], sequenceName.c_str(), stringBufLen);
+		memcpy(&cpuLump.data[cpuBufIt], sequenceName, stringBufLen);
 
 		pak->AddPointer(hdrLump, offsetof(AnimRecordingAssetHeader_s, animSequences) + i * sizeof(PagePtr_t), cpuLump, cpuBufIt);
 		cpuBufIt += stringBufLen;
+		fileOffset += stringBufLen;
 	}
 
 	// Now the frames and overlays are getting written out, these must be aligned
@@ -124,21 +171,18 @@ static void AnimRecording_InternalAddAnimRecording(CPakFileBuilder* const pak, c
 	cpuBufIt = IALIGN4(cpuBufIt);
 	pak->AddPointer(hdrLump, offsetof(AnimRecordingAssetHeader_s, recordedFrames), cpuLump, cpuBufIt);
 
-	for (int i = 0; i < fileHdr.numRecordedFrames; i++)
-	{
-		bio.Read(&cpuLump.data[cpuBufIt], sizeof(AnimRecordingFrame_s));
-		cpuBufIt += sizeof(AnimRecordingFrame_s);
-	}
+	const size_t animFramesBufSize = fileHdr.numRecordedFrames * sizeof(AnimRecordingFrame_s);
+
+	memcpy(&cpuLump.data[cpuBufIt], anirFile.GetData<uint8_t>(fileOffset), animFramesBufSize);
+	cpuBufIt += animFramesBufSize;
+	fileOffset += animFramesBufSize;
 
 	if (fileHdr.numRecordedOverlays > 0)
 	{
 		pak->AddPointer(hdrLump, offsetof(AnimRecordingAssetHeader_s, recordedOverlays), cpuLump, cpuBufIt);
 
-		for (int i = 0; i < fileHdr.numRecordedOverlays; i++)
-		{
-			bio.Read(&cpuLump.data[cpuBufIt], sizeof(AnimRecordingOverlay_s));
-			cpuBufIt += sizeof(AnimRecordingOverlay_s);
-		}
+		const size_t animOverlaysBufSize = fileHdr.numRecordedOverlays * sizeof(AnimRecordingOverlay_s);
+		memcpy(&cpuLump.data[cpuBufIt], anirFile.GetData<uint8_t>(fileOffset), animOverlaysBufSize);
 	}
 
 	asset.InitAsset(hdrLump.GetPointer(), sizeof(AnimRecordingAssetHeader_s), PagePtr_t::NullPtr(), ANIR_VERSION, AssetType::ANIR);
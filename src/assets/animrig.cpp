@@ -6,8 +6,8 @@
 
 extern PakGuid_t* AnimSeq_AutoAddSequenceRefs(CPakFileBuilder* const pak, uint32_t* const sequenceCount, const rapidjson::Value& mapEntry);
 
-// anim rigs are stored in rmdl's. use this to read it out.
-extern char* Model_ReadRMDLFile(const std::string& path, const uint64_t alignment);
+// anim rigs are stored in rmdl's. use this to map it in.
+extern const studiohdr_t* Model_MapRMDLFile(CMappedFile& modelFile, const std::string& path);
 
 // page chunk structure and order:
 // - header HEAD        (align=8)
@@ -24,9 +24,9 @@ void Assets::AddAnimRigAsset_v4(CPakFileBuilder* const pak, const PakGuid_t asse
     PakPageLump_s hdrChunk = pak->CreatePageLump(sizeof(AnimRigAssetHeader_t), SF_HEAD, 8);
     AnimRigAssetHeader_t* const pHdr = reinterpret_cast<AnimRigAssetHeader_t*>(hdrChunk.data);
 
-    // open and validate file to get buffer
-    char* const animRigFileBuffer = Model_ReadRMDLFile(pak->GetAssetPath() + assetPath, 8);
-    const studiohdr_t* const studiohdr = reinterpret_cast<const studiohdr_t*>(animRigFileBuffer);
+    // open and validate file to get the mapped view
+    CMappedFile animRigFile;
+    const studiohdr_t* const studiohdr = Model_MapRMDLFile(animRigFile, pak->GetAssetPath() + assetPath);
 
     // note: both of these are aligned to 1 byte, but we pad the rmdl buffer as
     // the guid ref block needs to be aligned to 8 bytes.
@@ -43,10 +43,10 @@ void Assets::AddAnimRigAsset_v4(CPakFileBuilder* const pak, const PakGuid_t asse
 
     studiohdr_t* const studioBuf = reinterpret_cast<studiohdr_t*>(&rigChunk.data[assetNameBufLen]);
 
-    memcpy(studioBuf, animRigFileBuffer, studiohdr->length);
+    memcpy(studioBuf, studiohdr, studiohdr->length);
     pak->AddPointer(hdrChunk, offsetof(AnimRigAssetHeader_t, data), rigChunk, assetNameBufLen);
 
-    delete[] animRigFileBuffer;
+    animRigFile.Close();
 
     if (sequenceRefs)
     {
@@ -13,7 +13,7 @@ enum AseqDependencyType_e : uint8_t
     ASEQ_DEP_COUNT // Not a type!
 };
 
-static void AnimSeq_ClassifyAndAddDependency(const char* const dependency, std::set<PakGuid_t>(&dependencies)[ASEQ_DEP_COUNT])
+static void AnimSeq_ClassifyAndAddDependency(const char* const dependency, std::vector<PakGuid_t>(&dependencies)[ASEQ_DEP_COUNT])
 {
     const PakGuid_t guid = RTech::StringToGuid(dependency);
     const uint32_t ident = (dependency[2] << 16) + (dependency[1] << 8) + dependency[0];
@@ -21,44 +21,55 @@ static void AnimSeq_ClassifyAndAddDependency(const char* const dependency, std::
     switch (ident)
     {
     case 'tes': // set (settings).
-        dependencies[ASEQ_DEP_SETTINGS].insert(guid);
+        dependencies[ASEQ_DEP_SETTINGS].push_back(guid);
         break;
     case 'ldm': // mdl (models).
-        dependencies[ASEQ_DEP_MODEL].insert(guid);
+        dependencies[ASEQ_DEP_MODEL].push_back(guid);
         break;
     default: // aseq, efct, etc...
-        dependencies[ASEQ_DEP_GENERIC].insert(guid);
+        dependencies[ASEQ_DEP_GENERIC].push_back(guid);
         break;
     }
 }
 
 // This parses all dependencies from the animation data itself, currently the
 // data only exists in animation sequence events.
-static void AnimSeq_ParseDependenciesFromData(const uint8_t* const data, std::set<PakGuid_t>(&dependencies)[ASEQ_DEP_COUNT])
+static void AnimSeq_ParseDependenciesFromData(const uint8_t* const data, std::vector<PakGuid_t>(&dependencies)[ASEQ_DEP_COUNT])
 {
     const mstudioseqdesc_t& seqdesc = *reinterpret_cast<const mstudioseqdesc_t*>(data);
 
     for (int i = 0; i < seqdesc.numevents; i++)
     {
         const mstudioevent_t* const event = seqdesc.pEvent(i);
-        const char* const depStart = strchr(event->options, '@');
 
-        if (!depStart || *(depStart + 1) == '\0')
+        // The options string is scanned once; the asset name is the token
+        // after the first ' ' that follows the '@'. The options buffer might
+        // not be null terminated if it's completely filled.
+        const char* cur = event->options;
+        const char* const optionsEnd = event->options + sizeof(event->options);
+
+        while (cur < optionsEnd && *cur && *cur != '@')
+            cur++;
+
+        if (cur + 1 >= optionsEnd || !*cur || cur[1] == '\0')
             continue; // '@' not found or nothing after '@'.
 
-        const char* start = strchr(depStart + 1, ' ');
+        cur++;
+
+        while (cur < optionsEnd && *cur && *cur != ' ')
+            cur++;
 
-        if (!start || *(start + 1) == '\0')
+        if (cur + 1 >= optionsEnd || !*cur || cur[1] == '\0')
             continue; // Start of asset name not found or empty.
 
         // Advance over the ' ' so it point directly at the
         // start of the asset name.
-        start++;
+        const char* const start = ++cur;
 
-        const char* end = strchr(start, ' ');
-        if (!end)
-            end = event->options + strlen(event->options);
+        while (cur < optionsEnd && *cur && *cur != ' ')
+            cur++;
 
+        const char* const end = cur;
         const size_t nameLen = (end - start);
 
         if (nameLen < ASEQ_DEPENDENCY_MIN_STR_LEN)
@@ -80,14 +91,16 @@ static void AnimSeq_ParseDependenciesFromData(const uint8_t* const data, std::se
 // file. If a sequence relies on another sequence, it must be added in this
 // metadata file in order for the game to precache it on time.
 static void AnimSeq_ParseDependenciesFromMap(CPakFileBuilder* const pak, const char* const assetPath,
-    std::set<PakGuid_t>(&dependencies)[ASEQ_DEP_COUNT])
+    std::vector<PakGuid_t>(&dependencies)[ASEQ_DEP_COUNT])
 {
     const std::string metaFilePath = Utils::ChangeExtension(pak->GetAssetPath() + assetPath, ".json");
-    rapidjson::Document document;
+    const std::shared_ptr<const rapidjson::Document> documentRef = JSON_GetCachedDocument(metaFilePath.c_str(), "animation metadata", false);
 
-    if (!JSON_ParseFromFile(metaFilePath.c_str(), "animation metadata", document, false))
+    if (!documentRef)
         return;
 
+    const rapidjson::Document& document = *documentRef;
+
     // Parse manually added entries here.
     rapidjson::Value::ConstMemberIterator dependenciesIt;
 
@@ -121,20 +134,37 @@ static void AnimSeq_ParseDependenciesFromMap(CPakFileBuilder* const pak, const c
         {
             PakGuid_t guid;
 
+            // From a numeric entry, we cannot classify what kind of asset it is.
+            // Store it as a generic dependency, if it was already classified as
+            // a model or settings dependency it will be dropped from the generic
+            // dependencies in AnimSeq_FinalizeDependencies().
             if (JSON_ParseNumber(dependency, guid))
-            {
-                if (dependencies[ASEQ_DEP_MODEL].find(guid) != dependencies[ASEQ_DEP_MODEL].end() ||
-                    dependencies[ASEQ_DEP_SETTINGS].find(guid) != dependencies[ASEQ_DEP_SETTINGS].end())
-                    continue;
-
-                // From a numeric entry, we cannot classify what kind of asset it is.
-                // Store it as a generic dependency.
-                dependencies[ASEQ_DEP_GENERIC].insert(guid);
-            }
+                dependencies[ASEQ_DEP_GENERIC].push_back(guid);
         }
     }
 }
 
+// Sorts the dependencies and drops the duplicates.
+static void AnimSeq_FinalizeDependencies(std::vector<PakGuid_t>(&dependencies)[ASEQ_DEP_COUNT])
+{
+    for (std::vector<PakGuid_t>& vec : dependencies)
+    {
+        std::sort(vec.begin(), vec.end());
+        vec.erase(std::unique(vec.begin(), vec.end()), vec.end());
+    }
+
+    const std::vector<PakGuid_t>& models = dependencies[ASEQ_DEP_MODEL];
+    const std::vector<PakGuid_t>& settings = dependencies[ASEQ_DEP_SETTINGS];
+
+    std::vector<PakGuid_t>& generic = dependencies[ASEQ_DEP_GENERIC];
+
+    generic.erase(std::remove_if(generic.begin(), generic.end(), [&](const PakGuid_t guid)
+        {
+            return std::binary_search(models.begin(), models.end(), guid) ||
+                std::binary_search(settings.begin(), settings.end(), guid);
+        }), generic.end());
+}
+
 // page chunk structure and order:
 // - header HEAD        (align=8)
 // - data   CPU         (align=1?8) dependencies, name, then rmdl. unlike models, this is aligned to 1 since we don't have BVH4 collision data here, aligned to 8 if we have dependencies.
@@ -165,10 +195,11 @@ static void AnimSeq_InternalAddAnimSeq(CPakFileBuilder* const pak, const PakGuid
     // Parse out the dependencies which we need to know in advance.
     // NOTE: original paks duplicate the dependencies for animation
     // sequences, but this is not necessary, so we drop duplicates.
-    std::set<PakGuid_t> dependencies[ASEQ_DEP_COUNT];
+    std::vector<PakGuid_t> dependencies[ASEQ_DEP_COUNT];
 
     AnimSeq_ParseDependenciesFromData(tempAseqBuf, dependencies);
     AnimSeq_ParseDependenciesFromMap(pak, assetPath, dependencies);
+    AnimSeq_FinalizeDependencies(dependencies);
 
     const size_t numDependencies = dependencies[ASEQ_DEP_GENERIC].size() + dependencies[ASEQ_DEP_MODEL].size() + dependencies[ASEQ_DEP_SETTINGS].size();
 
@@ -182,34 +213,28 @@ static void AnimSeq_InternalAddAnimSeq(CPakFileBuilder* const pak, const PakGuid
 
     for (size_t i = 0; i < ASEQ_DEP_COUNT; i++)
     {
-        const std::set<PakGuid_t>& set = dependencies[i];
+        const std::vector<PakGuid_t>& vec = dependencies[i];
 
-        if (set.empty())
+        if (vec.empty())
             continue;
 
         if (i == ASEQ_DEP_MODEL)
         {
             pak->AddPointer(hdrLump, offsetof(AnimSeqAssetHeader_t, pModels), dataLump, bufferBase);
-            hdr->modelCount = (uint32_t)set.size();
+            hdr->modelCount = (uint32_t)vec.size();
         }
         else if (i == ASEQ_DEP_SETTINGS)
         {
             pak->AddPointer(hdrLump, offsetof(AnimSeqAssetHeader_t, pSettings), dataLump, bufferBase);
-            hdr->settingsCount = (uint32_t)set.size();
+            hdr->settingsCount = (uint32_t)vec.size();
         }
 
-        for (size_t j = 0; j < set.size(); j++)
-        {
-            std::set<PakGuid_t>::iterator it = set.begin();
-            std::advance(it, j);
-
-            const PakGuid_t guidToCopy = *it;
-            reinterpret_cast<PakGuid_t*>(&dataLump.data[bufferBase])[j] = guidToCopy;
+        memcpy(&dataLump.data[bufferBase], vec.data(), vec.size() * sizeof(PakGuid_t));
 
-            Pak_RegisterGuidRefAtOffset(guidToCopy, bufferBase + (j * sizeof(PakGuid_t)), dataLump, asset);
-        }
+        for (size_t j = 0; j < vec.size(); j++)
+            Pak_RegisterGuidRefAtOffset(vec[j], bufferBase + (j * sizeof(PakGuid_t)), dataLump, asset);
 
-        bufferBase += set.size() * sizeof(PakGuid_t);
+        bufferBase += vec.size() * sizeof(PakGuid_t);
     }
 
     const size_t nameOffset = dependenciesBufSize;
@@ -2,30 +2,48 @@
 #include "assets.h"
 #include "public/datatable.h"
 
-static inline size_t DataTable_CalcColumnNameBufSize(const rapidcsv::Document& doc)
+#include <charconv>
+
+static inline size_t DataTable_CalcColumnNameBufSize(const CCsvReader& csv)
 {
     size_t colNameBufSize = 0;
 
     // get required size to store all of the column names in a single buffer
-    for (const std::string& it : doc.GetColumnNames())
+    for (size_t i = 0; i < csv.GetColumnCount(); ++i)
     {
-        colNameBufSize += it.length() + 1;
+        colNameBufSize += csv.GetColumnName(i).length() + 1;
     }
 
     return colNameBufSize;
 }
 
-static void DataTable_ReportInvalidDataTypeError(const char* const type, const uint32_t rowIdx, const uint32_t colIdx)
+static void DataTable_ReportInvalidDataTypeError(const std::string_view type, const uint32_t rowIdx, const uint32_t colIdx)
 {
-    Error("Invalid data type \"%s\" at cell [%u,%u].\n", type, rowIdx, colIdx);
+    Error("Invalid data type \"%.*s\" at cell [%u,%u].\n", static_cast<int>(type.length()), type.data(), rowIdx, colIdx);
 }
 
+// identical string values and asset guids are only stored once per table,
+// all cells with the same value point to the same string.
+struct DataTableValuePool_s
+{
+    std::unordered_map<std::string_view, size_t> stringOffsets; // offset of each unique string in the string value buffer.
+    std::vector<std::string_view> uniqueStrings; // in order of first occurrence.
+
+    std::unordered_set<PakGuid_t> guidRefSet;
+    std::vector<PakGuid_t> uniqueGuidRefs; // in order of first occurrence.
+
+    size_t numStringCells;
+    size_t numGuidRefCells;
+    size_t unpooledStringBufSize; // what the string buffer would've been without pooling.
+};
+
+// first sweep; validates the table layout, parses the type row and computes
+// the size of each value buffer.
 template <typename datatable_t>
-static size_t DataTable_SetupRows(const rapidcsv::Document& doc, datatable_t* const dtblHdr, datatable_asset_t& tmp, std::vector<std::string>& outTypeRow)
+static size_t DataTable_SetupRows(const CCsvReader& csv, datatable_t* const dtblHdr, datatable_asset_t& tmp, std::vector<dtblcoltype_t>& outColumnTypes,
+    DataTableValuePool_s& pool)
 {
-    // cache it so we don't have to make another deep copy.
-    outTypeRow = doc.GetRow<std::string>(dtblHdr->numRows);
-    const uint32_t numTypeNames = static_cast<uint32_t>(outTypeRow.size());
+    const uint32_t numTypeNames = static_cast<uint32_t>(csv.GetRowColumnCount(dtblHdr->numRows));
 
     // typically happens when there's an empty line in the csv file.
     if (numTypeNames != dtblHdr->numColumns)
@@ -35,47 +53,70 @@ static size_t DataTable_SetupRows(const rapidcsv::Document& doc, datatable_t* co
     // have the same number of columns as the type row. The column count in the
     // datatable header is set to the count in the type row and therefore all
     // other rows must match this count.
-    for (uint32_t i = 0; i < doc.GetRowCount(); ++i)
+    for (uint32_t i = 0; i < csv.GetRowCount(); ++i)
     {
-        const uint32_t columnCount = static_cast<uint32_t>(doc.GetColumnCount(i));
+        const uint32_t columnCount = static_cast<uint32_t>(csv.GetRowColumnCount(i));
 
         if (columnCount != dtblHdr->numColumns)
             Error("Expected %u columns for data row #%u, found %u.\n", dtblHdr->numColumns, i, columnCount);
     }
 
+    outColumnTypes.resize(dtblHdr->numColumns);
     size_t highestTypeAlign = 0;
 
     for (uint32_t i = 0; i < dtblHdr->numColumns; ++i)
     {
-        const std::string& typeString = outTypeRow[i];
-        const dtblcoltype_t type = DataTable_GetTypeFromString(typeString);
+        const std::string_view typeString = csv.GetCell(i, dtblHdr->numRows);
+        const dtblcoltype_t type = DataTable_GetTypeFromString(std::string(typeString));
 
         if (type == dtblcoltype_t::INVALID)
-            DataTable_ReportInvalidDataTypeError(typeString.c_str(), dtblHdr->numRows, i);
+            DataTable_ReportInvalidDataTypeError(typeString, dtblHdr->numRows, i);
 
         const size_t curTypeAlign = DataTable_GetAlignmentForType(type);
 
         if (curTypeAlign > highestTypeAlign)
             highestTypeAlign = curTypeAlign;
 
-        if (DataTable_IsStringType(type))
+        outColumnTypes[i] = type;
+        tmp.rowPodValueBufSize += static_cast<size_t>(DataTable_GetValueSize(type)) * dtblHdr->numRows; // size of type * row count (excluding the type row)
+    }
+
+    // string values are pooled in row order, as the cells are laid out that way.
+    for (uint32_t j = 0; j < dtblHdr->numRows; ++j)
+    {
+        for (uint32_t i = 0; i < dtblHdr->numColumns; ++i)
         {
-            const bool isPrecachedAsset = type == dtblcoltype_t::Asset;
+            const dtblcoltype_t type = outColumnTypes[i];
 
-            for (uint32_t j = 0; j < dtblHdr->numRows; ++j)
+            if (!DataTable_IsStringType(type))
+                continue;
+
+            const std::string_view val = csv.GetCell(i, j);
+            const size_t strLen = val.length();
+
+            // dtblcoltype_t::Asset types must be precached, add guid dependency
+            // that needs to be resolved in the runtime before this asset is parsed.
+            if (type == dtblcoltype_t::Asset && strLen > 0)
             {
-                // this can be std::string since we only deal with the string types here
-                std::vector<std::string> row = doc.GetRow<std::string>(j);
-                const size_t strLen = row[i].length();
+                const PakGuid_t assetGuid = RTech::StringToGuid(std::string(val).c_str());
+                pool.numGuidRefCells++;
 
-                if (isPrecachedAsset && strLen > 0)
+                if (pool.guidRefSet.insert(assetGuid).second)
+                {
+                    pool.uniqueGuidRefs.push_back(assetGuid);
                     tmp.guidRefBufSize += sizeof(PakGuid_t);
+                }
+            }
 
+            if (pool.stringOffsets.try_emplace(val, tmp.rowStringValueBufSize).second)
+            {
+                pool.uniqueStrings.push_back(val);
                 tmp.rowStringValueBufSize += strLen + 1;
             }
-        }
 
-        tmp.rowPodValueBufSize += static_cast<size_t>(DataTable_GetValueSize(type)) * dtblHdr->numRows; // size of type * row count (excluding the type row)
+            pool.numStringCells++;
+            pool.unpooledStringBufSize += strLen + 1;
+        }
     }
 
     return highestTypeAlign;
@@ -84,30 +125,27 @@ static size_t DataTable_SetupRows(const rapidcsv::Document& doc, datatable_t* co
 // fills a PakPageDataChunk_s with column data from a provided csv
 template <typename datatable_t>
 static void DataTable_SetupColumns(CPakFileBuilder* const pak, PakPageLump_s& dataChunk, const size_t columnNameBase, datatable_t* const dtblHdr,
-    datatable_asset_t& tmp, const rapidcsv::Document& doc, const std::vector<std::string>& typeRow)
+    datatable_asset_t& tmp, const CCsvReader& csv, const std::vector<dtblcoltype_t>& columnTypes)
 {
     char* const colNameBufBase = &dataChunk.data[columnNameBase];
     char* colNameBuf = colNameBufBase;
 
     for (uint32_t i = 0; i < dtblHdr->numColumns; ++i)
     {
-        const std::string name = doc.GetColumnName(i);
-        const size_t nameBufLen = name.length() + 1;
+        const std::string_view name = csv.GetColumnName(i);
+        const size_t nameLen = name.length();
 
-        // copy the column name into the namebuf
-        memcpy(colNameBuf, name.c_str(), nameBufLen);
+        // copy the column name into the namebuf, the lump is zero initialized
+        // so the null terminator is already there.
+        memcpy(colNameBuf, name.data(), nameLen);
 
         datacolumn_t& col = tmp.pDataColums[i];
 
         // register name pointer
         pak->AddPointer(dataChunk, ((sizeof(datacolumn_t) * i) + offsetof(datacolumn_t, pName)), dataChunk, columnNameBase + (colNameBuf - colNameBufBase));
-        colNameBuf += nameBufLen;
+        colNameBuf += nameLen + 1;
 
-        const std::string& typeString = typeRow[i];
-        const dtblcoltype_t type = DataTable_GetTypeFromString(typeString);
-
-        if (type == dtblcoltype_t::INVALID)
-            DataTable_ReportInvalidDataTypeError(typeString.c_str(), dtblHdr->numRows, i);
+        const dtblcoltype_t type = columnTypes[i];
 
         col.rowOffset = dtblHdr->rowStride;
         col.type = type;
@@ -116,16 +154,85 @@ static void DataTable_SetupColumns(CPakFileBuilder* const pak, PakPageLump_s& da
     }
 }
 
+static inline const char* DataTable_SkipSpaces(const char* cur, const char* const end)
+{
+    while (cur < end && (*cur == ' ' || *cur == '\t'))
+        cur++;
+
+    return cur;
+}
+
+// parses a number at the cursor, surrounding spaces are skipped. on failure,
+// the cursor is left at the position the number was expected at.
 template <typename T>
-static T DataTable_ParseCellFromDocument(rapidcsv::Document& doc, const uint32_t colIdx, const uint32_t rowIdx, const dtblcoltype_t type)
+static bool DataTable_ParseNumber(const char*& cur, const char* const end, T& out)
+{
+    cur = DataTable_SkipSpaces(cur, end);
+
+    // from_chars doesn't accept the plus sign.
+    const char* numStart = cur;
+
+    if (numStart < end && *numStart == '+')
+        numStart++;
+
+    std::from_chars_result result;
+
+    if constexpr (std::is_floating_point_v<T>)
+        result = std::from_chars(numStart, end, out, std::chars_format::general);
+    else
+        result = std::from_chars(numStart, end, out);
+
+    if (result.ec != std::errc())
+        return false;
+
+    cur = DataTable_SkipSpaces(result.ptr, end);
+    return true;
+}
+
+// ints are stored as 32 bits, but both signed and unsigned values are allowed.
+static bool DataTable_ParseInt(const char*& cur, const char* const end, uint32_t& out)
 {
-    try {
-        return doc.GetCell<T>(colIdx, rowIdx);
+    const char* const start = cur;
+    int64_t val;
+
+    if (!DataTable_ParseNumber(cur, end, val) || val < INT32_MIN || val > UINT32_MAX)
+    {
+        cur = DataTable_SkipSpaces(start, end);
+        return false;
     }
-    catch (const std::exception& ex) {
-        Error("Exception while parsing %s value from cell [%u,%u]: %s.\n", DataTable_GetStringFromType(type), rowIdx, colIdx, ex.what());
-        return T{};
+
+    out = static_cast<uint32_t>(val);
+    return true;
+}
+
+// parses a vector in the format "<x,y,z>".
+static bool DataTable_ParseVector(const char*& cur, const char* const end, Vector3& out)
+{
+    cur = DataTable_SkipSpaces(cur, end);
+
+    if (cur == end || *cur != '<')
+        return false;
+
+    cur++;
+    float components[3];
+
+    for (int i = 0; i < 3; i++)
+    {
+        if (!DataTable_ParseNumber(cur, end, components[i]))
+            return false;
+
+        const char delimiter = i < 2 ? ',' : '>';
+
+        if (cur == end || *cur != delimiter)
+            return false;
+
+        cur++;
     }
+
+    cur = DataTable_SkipSpaces(cur, end);
+    out = Vector3(components[0], components[1], components[2]);
+
+    return true;
 }
 
 static void DataTable_ReportInvalidValueError(const dtblcoltype_t type, const uint32_t rowIdx, const uint32_t colIdx)
@@ -133,16 +240,60 @@ static void DataTable_ReportInvalidValueError(const dtblcoltype_t type, const ui
     Error("Invalid %s value at cell [%u,%u].\n", DataTable_GetStringFromType(type), rowIdx, colIdx);
 }
 
-// fills a PakPageDataChunk_s with row data from a provided csv
-template <typename datatable_t>
-static void DataTable_SetupValues(CPakFileBuilder* const pak, PakAsset_t& asset, PakPageLump_s& dataChunk, const size_t guidRefBufBase,
-    const size_t podValueBase, const size_t stringValueBase, datatable_t* const dtblHdr, datatable_asset_t& tmp, rapidcsv::Document& doc)
+// parses the cell with given parser, the entire cell must be consumed.
+template <typename T, typename Parser>
+static T DataTable_ParseCell(const std::string_view cell, Parser parser, const dtblcoltype_t type, const uint32_t rowIdx, const uint32_t colIdx)
 {
-    char* const pStringBufBase = &dataChunk.data[stringValueBase];
-    char* pStringBuf = pStringBufBase;
+    const char* const begin = cell.data();
+    const char* const end = begin + cell.length();
+
+    const char* cur = begin;
+    T val{};
 
-    size_t curGuidRefIndex = 0;
+    if (!parser(cur, end, val) || cur != end)
+    {
+        Error("Invalid %s value \"%.*s\" at cell [%u,%u]; unexpected %s at position %zu.\n", DataTable_GetStringFromType(type),
+            static_cast<int>(cell.length()), cell.data(), rowIdx, colIdx, cur == end ? "end of value" : "character", static_cast<size_t>(cur - begin));
+    }
+
+    return val;
+}
 
+static bool DataTable_CellEqualsNoCase(const std::string_view cell, const char* const value)
+{
+    const size_t valueLen = strlen(value);
+    return cell.length() == valueLen && !_strnicmp(cell.data(), value, valueLen);
+}
+
+// writes the unique strings and asset guid refs collected in the first sweep
+static void DataTable_SetupPooledValues(PakAsset_t& asset, PakPageLump_s& dataChunk, const size_t guidRefBufBase,
+    const size_t stringValueBase, const DataTableValuePool_s& pool)
+{
+    size_t guidRefOffset = guidRefBufBase;
+
+    for (const PakGuid_t assetGuid : pool.uniqueGuidRefs)
+    {
+        *(PakGuid_t*)&dataChunk.data[guidRefOffset] = assetGuid;
+        Pak_RegisterGuidRefAtOffset(assetGuid, guidRefOffset, dataChunk, asset);
+
+        guidRefOffset += sizeof(PakGuid_t);
+    }
+
+    char* pStringBuf = &dataChunk.data[stringValueBase];
+
+    // the lump is zero initialized, so the null terminators are already there.
+    for (const std::string_view val : pool.uniqueStrings)
+    {
+        memcpy(pStringBuf, val.data(), val.length());
+        pStringBuf += val.length() + 1;
+    }
+}
+
+// second sweep; fills a PakPageDataChunk_s with row data from a provided csv
+template <typename datatable_t>
+static void DataTable_SetupValues(CPakFileBuilder* const pak, PakPageLump_s& dataChunk, const size_t podValueBase, const size_t stringValueBase,
+    datatable_t* const dtblHdr, datatable_asset_t& tmp, const CCsvReader& csv, const DataTableValuePool_s& pool)
+{
     for (uint32_t rowIdx = 0; rowIdx < dtblHdr->numRows; ++rowIdx)
     {
         for (uint32_t colIdx = 0; colIdx < dtblHdr->numColumns; ++colIdx)
@@ -159,11 +310,11 @@ static void DataTable_SetupValues(CPakFileBuilder* const pak, PakAsset_t& asset,
             {
             case dtblcoltype_t::Bool:
             {
-                const std::string val = DataTable_ParseCellFromDocument<std::string>(doc, colIdx, rowIdx, col.type);
+                const std::string_view val = csv.GetCell(colIdx, rowIdx);
 
-                if (!_stricmp(val.c_str(), "true") || val == "1")
+                if (DataTable_CellEqualsNoCase(val, "true") || val == "1")
                     valbuf.write<uint32_t>(true);
-                else if (!_stricmp(val.c_str(), "false") || val == "0")
+                else if (DataTable_CellEqualsNoCase(val, "false") || val == "0")
                     valbuf.write<uint32_t>(false);
                 else
                     DataTable_ReportInvalidValueError(col.type, rowIdx, colIdx);
@@ -172,66 +323,30 @@ static void DataTable_SetupValues(CPakFileBuilder* const pak, PakAsset_t& asset,
             }
             case dtblcoltype_t::Int:
             {
-                const uint32_t val = DataTable_ParseCellFromDocument<uint32_t>(doc, colIdx, rowIdx, col.type);
+                const uint32_t val = DataTable_ParseCell<uint32_t>(csv.GetCell(colIdx, rowIdx), DataTable_ParseInt, col.type, rowIdx, colIdx);
                 valbuf.write(val);
                 break;
             }
             case dtblcoltype_t::Float:
             {
-                const float val = DataTable_ParseCellFromDocument<float>(doc, colIdx, rowIdx, col.type);
+                const float val = DataTable_ParseCell<float>(csv.GetCell(colIdx, rowIdx), DataTable_ParseNumber<float>, col.type, rowIdx, colIdx);
                 valbuf.write(val);
                 break;
             }
             case dtblcoltype_t::Vector:
             {
-                std::string val = DataTable_ParseCellFromDocument<std::string>(doc, colIdx, rowIdx, col.type);
-                std::smatch sm;
-
-                // get values from format "<x,y,z>"
-                const bool result = std::regex_search(val, sm, std::regex("<(.*),(.*),(.*)>"));
-
-                // 0 - all
-                // 1 - x
-                // 2 - y
-                // 3 - z
-                if (result && (sm.size() == 4))
-                {
-                    const Vector3 vec(
-                        static_cast<float>(atof(sm[1].str().c_str())),
-                        static_cast<float>(atof(sm[2].str().c_str())),
-                        static_cast<float>(atof(sm[3].str().c_str())));
-
-                    valbuf.write(vec);
-                }
-                else
-                    DataTable_ReportInvalidValueError(col.type, rowIdx, colIdx);
+                const Vector3 val = DataTable_ParseCell<Vector3>(csv.GetCell(colIdx, rowIdx), DataTable_ParseVector, col.type, rowIdx, colIdx);
+                valbuf.write(val);
                 break;
             }
             case dtblcoltype_t::String:
             case dtblcoltype_t::Asset:
             case dtblcoltype_t::AssetNoPrecache:
             {
-                const std::string val = DataTable_ParseCellFromDocument<std::string>(doc, colIdx, rowIdx, col.type);
-                const size_t valBufLen = val.length()+1;
-
-                // dtblcoltype_t::Asset types must be precached, add guid dependency
-                // that needs to be resolved in the runtime before this asset is parsed.
-                if (valBufLen > 1 && col.type == dtblcoltype_t::Asset)
-                {
-                    const PakGuid_t assetGuid = RTech::StringToGuid(val.c_str());
-                    const size_t guidRefOffset = guidRefBufBase + curGuidRefIndex;
-
-                    *(PakGuid_t*)&dataChunk.data[guidRefOffset] = assetGuid;
-                    Pak_RegisterGuidRefAtOffset(assetGuid, guidRefOffset, dataChunk, asset);
-
-                    curGuidRefIndex += sizeof(PakGuid_t);
-                }
-
-                memcpy(pStringBuf, val.c_str(), valBufLen);
-                valbuf.write(dataChunk.GetPointer(stringValueBase + (pStringBuf - pStringBufBase)));
+                const size_t stringOffset = pool.stringOffsets.at(csv.GetCell(colIdx, rowIdx));
+                valbuf.write(dataChunk.GetPointer(stringValueBase + stringOffset));
 
                 pak->AddPointer(dataChunk, podValueBase + valueOffset);
-                pStringBuf += valBufLen;
 
                 break;
             }
@@ -250,13 +365,12 @@ static void DataTable_AddDataTable(CPakFileBuilder* const pak, const PakGuid_t a
     PakAsset_t& asset = pak->BeginAsset(assetGuid, assetPath);
 
     const std::string datatableFile = Utils::ChangeExtension(pak->GetAssetPath() + assetPath, ".csv");
-    std::ifstream datatableStream(datatableFile);
+    CCsvReader csv;
 
-    if (!datatableStream.is_open())
+    if (!csv.Open(datatableFile))
         Error("Failed to open datatable asset \"%s\".\n", datatableFile.c_str());
 
-    rapidcsv::Document doc(datatableStream);
-    const size_t columnCount = doc.GetColumnCount();
+    const size_t columnCount = csv.GetColumnCount();
 
     if (columnCount == 0)
     {
@@ -264,7 +378,7 @@ static void DataTable_AddDataTable(CPakFileBuilder* const pak, const PakGuid_t a
         return;
     }
 
-    const size_t rowCount = doc.GetRowCount();
+    const size_t rowCount = csv.GetRowCount();
 
     if (rowCount < 2)
     {
@@ -283,14 +397,16 @@ static void DataTable_AddDataTable(CPakFileBuilder* const pak, const PakGuid_t a
     datatable_t* const dtblHdr = reinterpret_cast<datatable_t*>(hdrChunk.data);
     datatable_asset_t dtblAsset{}; // temp header that we store values in.
 
-    dtblHdr->numColumns = static_cast<uint32_t>(doc.GetColumnCount());
-    dtblHdr->numRows = static_cast<uint32_t>(doc.GetRowCount() - 1); // -1 because last row isn't added (used for type info)
+    dtblHdr->numColumns = static_cast<uint32_t>(columnCount);
+    dtblHdr->numRows = static_cast<uint32_t>(rowCount - 1); // -1 because last row isn't added (used for type info)
 
-    std::vector<std::string> typeRow;
-    const size_t valueBufAlign = DataTable_SetupRows(doc, dtblHdr, dtblAsset, typeRow);
+    std::vector<dtblcoltype_t> columnTypes;
+    DataTableValuePool_s valuePool{};
+
+    const size_t valueBufAlign = DataTable_SetupRows(csv, dtblHdr, dtblAsset, columnTypes, valuePool);
 
     const size_t dataColumnsBufSize = dtblHdr->numColumns * sizeof(datacolumn_t);
-    const size_t columnNamesBufSize = IALIGN(DataTable_CalcColumnNameBufSize(doc), valueBufAlign);
+    const size_t columnNamesBufSize = IALIGN(DataTable_CalcColumnNameBufSize(csv), valueBufAlign);
 
     const size_t totalChunkSize = dataColumnsBufSize + columnNamesBufSize + dtblAsset.guidRefBufSize + dtblAsset.rowPodValueBufSize + dtblAsset.rowStringValueBufSize;
 
@@ -304,7 +420,7 @@ static void DataTable_AddDataTable(CPakFileBuilder* const pak, const PakGuid_t a
     pak->AddPointer(hdrChunk, offsetof(datatable_v1_t, pColumns), dataChunk, 0);
 
     // setup data in column data chunk
-    DataTable_SetupColumns(pak, dataChunk, dataColumnsBufSize, dtblHdr, dtblAsset, doc, typeRow);
+    DataTable_SetupColumns(pak, dataChunk, dataColumnsBufSize, dtblHdr, dtblAsset, csv, columnTypes);
 
     // Plain-old-data and string values use different buffers!
     const size_t guidRefBufBase = dataColumnsBufSize + columnNamesBufSize;
@@ -312,7 +428,18 @@ static void DataTable_AddDataTable(CPakFileBuilder* const pak, const PakGuid_t a
     const size_t rowStringValuesBase = rowPodValuesBase + dtblAsset.rowPodValueBufSize;
 
     // setup row data chunks
-    DataTable_SetupValues(pak, asset, dataChunk, guidRefBufBase, rowPodValuesBase, rowStringValuesBase, dtblHdr, dtblAsset, doc);
+    DataTable_SetupPooledValues(asset, dataChunk, guidRefBufBase, rowStringValuesBase, valuePool);
+    DataTable_SetupValues(pak, dataChunk, rowPodValuesBase, rowStringValuesBase, dtblHdr, dtblAsset, csv, valuePool);
+
+    const size_t pooledStringSavings = valuePool.unpooledStringBufSize - dtblAsset.rowStringValueBufSize;
+    const size_t pooledGuidRefSavings = (valuePool.numGuidRefCells - valuePool.uniqueGuidRefs.size()) * sizeof(PakGuid_t);
+
+    if (pooledStringSavings > 0 || pooledGuidRefSavings > 0)
+    {
+        Log("Pooled %zu string cells into %zu unique strings and %zu asset references into %zu guid refs; saved %zu bytes of CPU page data.\n",
+            valuePool.numStringCells, valuePool.uniqueStrings.size(), valuePool.numGuidRefCells, valuePool.uniqueGuidRefs.size(),
+            pooledStringSavings + pooledGuidRefSavings);
+    }
 
     // datatable v0 and v1 use the same struct offset for pRows.
     pak->AddPointer(hdrChunk, offsetof(datatable_v0_t, pRows), dataChunk, rowPodValuesBase);
@@ -5,11 +5,13 @@
 static void LcdScreenEffect_InternalAddRLCD(CPakFileBuilder* const pak, const PakGuid_t assetGuid, const char* const assetPath)
 {
 	const std::string rlcdPath = Utils::ChangeExtension(pak->GetAssetPath() + assetPath, "json");
-	rapidjson::Document document;
+	const std::shared_ptr<const rapidjson::Document> documentRef = JSON_GetCachedDocument(rlcdPath.c_str(), "lcd screen effect", false);
 
-	if (!JSON_ParseFromFile(rlcdPath.c_str(), "lcd screen effect", document, false))
+	if (!documentRef)
 		Error("Failed to open lcd_screen_effect asset \"%s\".\n", rlcdPath.c_str());
 
+	const rapidjson::Document& document = *documentRef;
+
 	PakAsset_t& asset = pak->BeginAsset(assetGuid, assetPath);
 	PakPageLump_s hdrLump = pak->CreatePageLump(sizeof(LcdScreenEffect_s), SF_HEAD | SF_CLIENT, 4);
 
@@ -5,11 +5,13 @@
 static void Material4Aspect_InternalAdd(CPakFileBuilder* const pak, const PakGuid_t assetGuid, const char* const assetPath)
 {
 	const std::string mt4aPath = Utils::ChangeExtension(pak->GetAssetPath() + assetPath, "json");
-	rapidjson::Document document;
+	const std::shared_ptr<const rapidjson::Document> documentRef = JSON_GetCachedDocument(mt4aPath.c_str(), "material for aspect", false);
 
-	if (!JSON_ParseFromFile(mt4aPath.c_str(), "material for aspect", document, false))
+	if (!documentRef)
 		Error("Failed to open material_for_aspect asset \"%s\".\n", mt4aPath.c_str());
 
+	const rapidjson::Document& document = *documentRef;
+
 	// Parse manually added entries here.
 	rapidjson::Value::ConstMemberIterator materialsIt;
 	JSON_GetRequired(document, "materials", JSONFieldType_e::kArray, materialsIt);
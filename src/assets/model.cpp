@@ -2,12 +2,13 @@
 #include "assets.h"
 #include "public/studio.h"
 #include "public/material.h"
+#include "utils/meshutils.h"
 
-char* Model_ReadRMDLFile(const std::string& path, const uint64_t alignment = 64)
+// maps and validates the rmdl file, the returned header points into the mapped
+// view and is therefore read only, copy it into the page lump to modify it.
+const studiohdr_t* Model_MapRMDLFile(CMappedFile& modelFile, const std::string& path)
 {
-    BinaryIO modelFile;
-
-    if (!modelFile.Open(path, BinaryIO::Mode_e::Read))
+    if (!modelFile.Open(path))
         Error("Failed to open model file \"%s\".\n", path.c_str());
 
     const size_t fileSize = modelFile.GetSize();
@@ -15,10 +16,7 @@ char* Model_ReadRMDLFile(const std::string& path, const uint64_t alignment = 64)
     if (fileSize < sizeof(studiohdr_t))
         Error("Invalid model file \"%s\"; must be at least %zu bytes, found %zu.\n", path.c_str(), sizeof(studiohdr_t), fileSize);
 
-    char* const buf = new char[IALIGN(fileSize, alignment)];
-    modelFile.Read(buf, fileSize);
-
-    studiohdr_t* const pHdr = reinterpret_cast<studiohdr_t*>(buf);
+    const studiohdr_t* const pHdr = modelFile.GetData<studiohdr_t>();
 
     if (pHdr->id != 'TSDI') // "IDST"
         Error("Invalid model file \"%s\"; expected magic %x, found %x.\n", path.c_str(), 'TSDI', pHdr->id);
@@ -29,38 +27,20 @@ char* Model_ReadRMDLFile(const std::string& path, const uint64_t alignment = 64)
     if (pHdr->length > fileSize)
         Error("Invalid model file \"%s\"; studiohdr->length(%zu) > fileSize(%zu).\n", path.c_str(), (size_t)pHdr->length, fileSize);
 
-    return buf;
+    return pHdr;
 }
 
-static char* Model_ReadVGFile(const std::string& path, int64_t* const pFileSize, size_t* const pFileSizePageAligned)
+static const VertexGroupHeader_t* Model_MapVGFile(CMappedFile& vgFile, const std::string& path)
 {
-    BinaryIO vgFile;
-
-    if (!vgFile.Open(path, BinaryIO::Mode_e::Read))
+    if (!vgFile.Open(path))
         Error("Failed to open vertex group file \"%s\".\n", path.c_str());
 
-    const int64_t fileSize = vgFile.GetSize();
+    const size_t fileSize = vgFile.GetSize();
 
     if (fileSize < sizeof(VertexGroupHeader_t))
         Error("Invalid vertex group file \"%s\"; must be at least %zu bytes, found %zu.\n", path.c_str(), sizeof(VertexGroupHeader_t), fileSize);
 
-    // note(amos): need to align it to STARPAK_DATABLOCK_ALIGNMENT since the
-    // actual VG is also aligned to this value in the starpak, and the table at
-    // the end of the starpak (see struct PakStreamSetAssetEntry_s in starpak.h
-    // ), that we use for data deduplication, stores the asset's size aligned
-    // so in order to yield the same hash we need to hash the data page aligned.
-    const size_t fileSizePageAligned = IALIGN(fileSize, STARPAK_DATABLOCK_ALIGNMENT);
-
-    char* const buf = new char[fileSizePageAligned];
-    vgFile.Read(buf, fileSize);
-
-    const size_t remainder = fileSizePageAligned - fileSize;
-
-    // Null the rest since this will affect the hash result.
-    if (remainder > 0)
-        memset(&buf[fileSize], 0, remainder);
-
-    VertexGroupHeader_t* const pHdr = reinterpret_cast<VertexGroupHeader_t*>(buf);
+    const VertexGroupHeader_t* const pHdr = vgFile.GetData<VertexGroupHeader_t>();
 
     if (pHdr->id != 'GVt0') // "0tVG"
         Error("Invalid vertex group file \"%s\"; expected magic %x, found %x.\n", path.c_str(), 'GVt0', pHdr->id);
@@ -69,10 +49,125 @@ static char* Model_ReadVGFile(const std::string& path, int64_t* const pFileSize,
     if (pHdr->version != 1)
         Error("Invalid vertex group file \"%s\"; expected version %i, found %i.\n", path.c_str(), 1, pHdr->version);
 
-    *pFileSize = fileSize;
-    *pFileSizePageAligned = fileSizePageAligned;
+    return pHdr;
+}
+
+static bool Model_IsVGTableInRange(const size_t vgSize, const __int64 offset, const __int64 count, const size_t elemSize)
+{
+    if (offset < 0 || count < 0)
+        return false;
+
+    return (static_cast<size_t>(offset) + (static_cast<size_t>(count) * elemSize)) <= vgSize;
+}
+
+//-----------------------------------------------------------------------------
+// reorders the triangles of every triangle list strip for post-transform cache
+// efficiency, and the vertices of every mesh for fetch locality. the number of
+// indices and vertices per strip and mesh remain the same, so the mesh and
+// strip tables stay valid. meshes we cannot safely reorder are left as is.
+//-----------------------------------------------------------------------------
+static void Model_OptimizeVertexGroupMeshes(uint8_t* const vgBuf, const size_t vgSize, const std::string& vgFilePath)
+{
+    const VertexGroupHeader_t* const pHdr = reinterpret_cast<const VertexGroupHeader_t*>(vgBuf);
+
+    if (!Model_IsVGTableInRange(vgSize, pHdr->meshOffset, pHdr->numMeshes, sizeof(VertexGroupMesh_t)) ||
+        !Model_IsVGTableInRange(vgSize, pHdr->indexOffset, pHdr->numIndices, sizeof(uint16_t)) ||
+        !Model_IsVGTableInRange(vgSize, pHdr->vertOffset, pHdr->vertDataSize, sizeof(uint8_t)) ||
+        !Model_IsVGTableInRange(vgSize, pHdr->stripOffset, pHdr->numStrips, sizeof(VertexGroupStrip_t)))
+    {
+        Warning("Vertex group file \"%s\" has tables that exceed the file size; skipping mesh optimization.\n", vgFilePath.c_str());
+        return;
+    }
+
+    VertexGroupMesh_t* const meshes = reinterpret_cast<VertexGroupMesh_t*>(&vgBuf[pHdr->meshOffset]);
+    VertexGroupStrip_t* const strips = reinterpret_cast<VertexGroupStrip_t*>(&vgBuf[pHdr->stripOffset]);
+
+    uint16_t* const indices = reinterpret_cast<uint16_t*>(&vgBuf[pHdr->indexOffset]);
+    uint8_t* const vertices = &vgBuf[pHdr->vertOffset];
+
+    size_t numOptimizedMeshes = 0;
+    size_t numTris = 0;
+
+    float missesBefore = 0.0f;
+    float missesAfter = 0.0f;
+
+    for (__int64 i = 0; i < pHdr->numMeshes; i++)
+    {
+        const VertexGroupMesh_t& mesh = meshes[i];
+
+        if (!mesh.indexCount || !mesh.vertCount)
+            continue;
+
+        if (mesh.indexOffset < 0 || mesh.indexCount < 0 || (mesh.indexOffset + mesh.indexCount) > pHdr->numIndices ||
+            mesh.stripOffset < 0 || mesh.stripCount < 0 || (mesh.stripOffset + mesh.stripCount) > pHdr->numStrips ||
+            (static_cast<__int64>(mesh.vertOffset) + (static_cast<__int64>(mesh.vertCount) * mesh.vertCacheSize)) > pHdr->vertDataSize)
+        {
+            Warning("Mesh #%lld in vertex group file \"%s\" is out of range; skipping.\n", i, vgFilePath.c_str());
+            continue;
+        }
+
+        uint16_t* const meshIndices = &indices[mesh.indexOffset];
+        bool validIndices = true;
+
+        for (int j = 0; j < mesh.indexCount; j++)
+        {
+            if (meshIndices[j] >= mesh.vertCount)
+            {
+                validIndices = false;
+                break;
+            }
+        }
+
+        if (!validIndices)
+        {
+            Warning("Mesh #%lld in vertex group file \"%s\" references vertices outside the mesh; skipping.\n", i, vgFilePath.c_str());
+            continue;
+        }
+
+        // vertices can only be moved around if they belong to a single strip
+        // and aren't referenced by anything other than the indices.
+        bool canReorderVertices = mesh.vertCacheSize > 0 && mesh.legacyWeightCount == 0 && mesh.stripCount == 1;
+
+        for (int j = 0; j < mesh.stripCount; j++)
+        {
+            const VertexGroupStrip_t& strip = strips[mesh.stripOffset + j];
+
+            if (strip.numTopologyIndices > 0 || strip.vertOffset != 0 || strip.numVerts != static_cast<int>(mesh.vertCount))
+                canReorderVertices = false;
+
+            if (!(strip.flags & VG_STRIP_IS_TRILIST) || (strip.numIndices % 3) != 0 ||
+                strip.indexOffset < 0 || strip.numIndices < 0 || (strip.indexOffset + strip.numIndices) > mesh.indexCount)
+            {
+                // strips must keep their order, and we don't know what else
+                // is indexing into them.
+                canReorderVertices = false;
+                continue;
+            }
+
+            uint16_t* const stripIndices = &meshIndices[strip.indexOffset];
+            const size_t stripTris = strip.numIndices / 3;
+
+            missesBefore += Mesh_CalcACMR(stripIndices, strip.numIndices, mesh.vertCount) * stripTris;
+            Mesh_OptimizeVertexCache(stripIndices, strip.numIndices, mesh.vertCount);
+            missesAfter += Mesh_CalcACMR(stripIndices, strip.numIndices, mesh.vertCount) * stripTris;
+
+            numTris += stripTris;
+        }
+
+        if (canReorderVertices)
+            Mesh_OptimizeVertexFetch(meshIndices, mesh.indexCount, &vertices[mesh.vertOffset], mesh.vertCount, mesh.vertCacheSize);
+
+        numOptimizedMeshes++;
+    }
 
-    return buf;
+    if (!numTris)
+    {
+        Warning("Vertex group file \"%s\" has no triangle lists to optimize.\n", vgFilePath.c_str());
+        return;
+    }
+
+    Log("Optimized %zu meshes (%zu triangles) in vertex group file \"%s\"; ACMR %.3f -> %.3f.\n",
+        numOptimizedMeshes, numTris, vgFilePath.c_str(), missesBefore / numTris, missesAfter / numTris);
 }
 
 static PakGuid_t* Model_AddAnimRigRefs(uint32_t* const animrigCount, const rapidjson::Value& mapEntry)
@@ -170,7 +265,7 @@ static void Model_AllocateIntermediateDataChunk(CPakFileBuilder* const pak, PakP
     }
 }
 
-static void Model_InternalAddVertexGroupData(CPakFileBuilder* const pak, PakPageLump_s* const hdrChunk, ModelAssetHeader_t* const modelHdr, studiohdr_t* const studiohdr, const std::string& rmdlFilePath, PakStreamSetEntry_s& de)
+static void Model_InternalAddVertexGroupData(CPakFileBuilder* const pak, PakPageLump_s* const hdrChunk, ModelAssetHeader_t* const modelHdr, const studiohdr_t* const studiohdr, const std::string& rmdlFilePath, const bool optimizeMeshes, PakStreamSetEntry_s& de)
 {
     modelHdr->totalVertexDataSize = studiohdr->vtxsize + studiohdr->vvdsize + studiohdr->vvcsize + studiohdr->vvwsize;
 
@@ -180,10 +275,36 @@ static void Model_InternalAddVertexGroupData(CPakFileBuilder* const pak, PakPage
     // this data is a combined mutated version of the data from .vtx and .vvd in regular source models
     const std::string vgFilePath = Utils::ChangeExtension(rmdlFilePath, ".vg");
 
-    int64_t vgFileSize = 0; size_t vgSizeAligned = 0;
-    char* const vgBuf = Model_ReadVGFile(vgFilePath, &vgFileSize, &vgSizeAligned);
+    CMappedFile vgFile;
+    Model_MapVGFile(vgFile, vgFilePath);
+
+    const size_t vgFileSize = vgFile.GetSize();
+    const uint8_t* vgData = vgFile.GetData();
+
+    // the optimizer rewrites the index and vertex buffers in place, so only
+    // in this case we need a writable copy of the VG.
+    std::unique_ptr<uint8_t[]> optimizedVg;
+
+    if (optimizeMeshes)
+    {
+        optimizedVg.reset(new uint8_t[vgFileSize]);
+        memcpy(optimizedVg.get(), vgData, vgFileSize);
+
+        vgFile.Close();
 
-    de = pak->AddStreamingDataEntry(vgSizeAligned, (uint8_t*)vgBuf, STREAMING_SET_MANDATORY);
+        Model_OptimizeVertexGroupMeshes(optimizedVg.get(), vgFileSize, vgFilePath);
+        vgData = optimizedVg.get();
+    }
+
+    // note(amos): the VG is aligned to STARPAK_DATABLOCK_ALIGNMENT in the
+    // starpak, and the table at the end of the starpak (see struct
+    // PakStreamSetAssetEntry_s in starpak.h), that we use for data
+    // deduplication, stores the asset's size aligned. The stream builder
+    // hashes and pads the tail out for us, so we can pass the mapped view
+    // straight through without making a page aligned copy of it first.
+    const size_t vgSizeAligned = IALIGN(vgFileSize, STARPAK_DATABLOCK_ALIGNMENT);
+
+    de = pak->AddStreamingDataEntry(vgFileSize, vgData, STREAMING_SET_MANDATORY);
 
     assert(vgSizeAligned <= UINT32_MAX);
     modelHdr->streamedVertexDataSize = static_cast<uint32_t>(vgSizeAligned);
@@ -191,11 +312,11 @@ static void Model_InternalAddVertexGroupData(CPakFileBuilder* const pak, PakPage
     // static props must have their vertex group data copied as permanent data in the pak file.
     if (studiohdr->IsStaticProp())
     {
-        PakPageLump_s vgLump = pak->CreatePageLump(vgFileSize, SF_CPU | SF_TEMP | SF_CLIENT, 1, vgBuf);
+        PakPageLump_s vgLump = pak->CreatePageLump(vgFileSize, SF_CPU | SF_TEMP | SF_CLIENT, 1);
+        memcpy(vgLump.data, vgData, vgFileSize);
+
         pak->AddPointer(*hdrChunk, offsetof(ModelAssetHeader_t, pStaticPropVtxCache), vgLump, 0);
     }
-    else
-        delete[] vgBuf;
 }
 
 static void Model_InternalHandleMaterials(CPakFileBuilder* const pak, const rapidjson::Value& mapEntry, 
@@ -300,18 +421,20 @@ void Assets::AddModelAsset_v9(CPakFileBuilder* const pak, const PakGuid_t assetG
 
     const std::string rmdlFilePath = pak->GetAssetPath() + assetPath;
 
-    char* const rmdlBuf = Model_ReadRMDLFile(rmdlFilePath);
-    studiohdr_t* const studiohdr = reinterpret_cast<studiohdr_t*>(rmdlBuf);
+    // the rmdl, vg and phy files are mapped rather than read, so the data is
+    // only copied once into the lumps and stream files it will end up in.
+    CMappedFile rmdlFile;
+    const studiohdr_t* const mappedStudiohdr = Model_MapRMDLFile(rmdlFile, rmdlFilePath);
 
     //
     // Physics
     //
-    const bool physicsRequired = studiohdr->vphysize != 0;
+    const bool physicsRequired = mappedStudiohdr->vphysize != 0;
 
-    BinaryIO phyInput;
+    CMappedFile phyInput;
     const std::string physicsFile = Utils::ChangeExtension(rmdlFilePath, ".phy");
 
-    if (phyInput.Open(physicsFile, BinaryIO::Mode_e::Read))
+    if (phyInput.Open(physicsFile))
     {
         const size_t phyFileSize = phyInput.GetSize();
 
@@ -321,12 +444,13 @@ void Assets::AddModelAsset_v9(CPakFileBuilder* const pak, const PakGuid_t assetG
         if (!phyFileSize)
             Error("Physics file \"%s\" appears truncated.\n", physicsFile.c_str());
 
-        if (physicsRequired && (studiohdr->vphysize != phyFileSize))
-            Error("Physics file \"%s\" has a size of %zu, but the model expected a size of %zu.\n", physicsFile.c_str(), phyFileSize, (size_t)studiohdr->vphysize);
+        if (physicsRequired && (mappedStudiohdr->vphysize != phyFileSize))
+            Error("Physics file \"%s\" has a size of %zu, but the model expected a size of %zu.\n", physicsFile.c_str(), phyFileSize, (size_t)mappedStudiohdr->vphysize);
 
         PakPageLump_s phyChunk = pak->CreatePageLump(phyFileSize, SF_CPU | SF_TEMP, 1);
-        phyInput.Read(phyChunk.data, phyFileSize);
+        memcpy(phyChunk.data, phyInput.GetData(), phyFileSize);
 
+        phyInput.Close();
         pak->AddPointer(hdrChunk, offsetof(ModelAssetHeader_t, pPhyData), phyChunk, 0);
     }
     else if (physicsRequired)
@@ -340,12 +464,23 @@ void Assets::AddModelAsset_v9(CPakFileBuilder* const pak, const PakGuid_t assetG
     const bool keepClientOnly = pak->IsFlagSet(PF_KEEP_CLIENT);
 
     if (keepClientOnly)
-        Model_InternalAddVertexGroupData(pak, &hdrChunk, pHdr, studiohdr, rmdlFilePath, streamedVg);
+    {
+        // opt-in; reorders the VG's index and vertex buffers for GPU cache efficiency.
+        const bool optimizeMeshes = JSON_GetValueOrDefault(mapEntry, "$optimizeMeshes", false);
+        Model_InternalAddVertexGroupData(pak, &hdrChunk, pHdr, mappedStudiohdr, rmdlFilePath, optimizeMeshes, streamedVg);
+    }
 
     // the last chunk is the actual data chunk that contains the rmdl
-    PakPageLump_s dataChunk = pak->CreatePageLump(studiohdr->length, SF_CPU, 64, rmdlBuf);
+    PakPageLump_s dataChunk = pak->CreatePageLump(mappedStudiohdr->length, SF_CPU, 64);
+    memcpy(dataChunk.data, mappedStudiohdr, mappedStudiohdr->length);
+
+    rmdlFile.Close();
     pak->AddPointer(hdrChunk, offsetof(ModelAssetHeader_t, pData), dataChunk, 0);
 
+    // from here on, the studiohdr must be accessed from the lump as the
+    // material guids are patched in place.
+    studiohdr_t* const studiohdr = reinterpret_cast<studiohdr_t*>(dataChunk.data);
+
     if (keepClientOnly)
         Model_InternalHandleMaterials(pak, mapEntry, asset, studiohdr, dataChunk);
 
@@ -7,28 +7,33 @@
 #define SETTINGS_MODS_NAMES_FIELD "$modNames"
 #define SETTINGS_MODS_VALUES_FIELD "$modValues"
 
-static void SettingsAsset_OpenFile(CPakFileBuilder* const pak, const char* const assetPath, rapidjson::Document& document)
+static std::shared_ptr<const rapidjson::Document> SettingsAsset_OpenFile(CPakFileBuilder* const pak, const char* const assetPath)
 {
     const string fileName = Utils::ChangeExtension(pak->GetAssetPath() + assetPath, ".json");
+    std::shared_ptr<const rapidjson::Document> document = JSON_GetCachedDocument(fileName.c_str(), "settings asset", true);
 
-    if (!JSON_ParseFromFile(fileName.c_str(), "settings asset", document, true))
+    if (!document)
         Error("Failed to open settings asset \"%s\".\n", fileName.c_str());
+
+    return document;
 }
 
-static int64_t FindColumnCell(const std::vector<std::string>& column, const char* const name, const int occurrence)
+// finds the first field with given name that wasn't mapped yet, the
+// occurrence of the field is written to outOccurrence.
+static int64_t FindColumnCell(const SettingsLayoutParseResult_s& layout, const char* const name, const std::vector<bool>& mappedFields, int& outOccurrence)
 {
-    const int64_t numColumns = static_cast<int64_t>(column.size());
-    int numFound = 0;
+    outOccurrence = 0;
+    const auto it = layout.fieldNameMap.find(name);
+
+    if (it == layout.fieldNameMap.end())
+        return -1;
 
-    for (int64_t i = 0; i < numColumns; i++)
+    for (const uint32_t fieldIndex : it->second)
     {
-        const std::string& entry = column[i];
+        if (!mappedFields[fieldIndex])
+            return fieldIndex;
 
-        if (entry.compare(name) == 0)
-        {
-            if (numFound++ == occurrence)
-                return i;
-        }
+        outOccurrence++;
     }
 
     return -1;
@@ -115,19 +120,19 @@ static void SettingsAsset_InitializeAndMap(const char* const layoutAssetPath, Se
         settingsMemory.valueBufSize += layoutAsset.rootLayout.totalValueBufferSize;
     }
 
-    std::map<std::string, int> occurenceMap;
+    std::vector<bool> mappedFields(numLayoutFields, false);
 
     for (const auto& it : value.GetObject())
     {
         const char* const fieldName = it.name.GetString();
-        int& occurence = occurenceMap[fieldName];
+        int occurence;
 
-        const int64_t cellIndex = FindColumnCell(layoutAsset.rootLayout.fieldNames, fieldName, occurence);
+        const int64_t cellIndex = FindColumnCell(layoutAsset.rootLayout, fieldName, mappedFields, occurence);
 
         if (cellIndex == -1)
             Error("Field \"%s\" with occurrence #%d does not exist in settings layout \"%s\".\n", fieldName, occurence, layoutAssetPath);
 
-        occurence++;
+        mappedFields[cellIndex] = true;
         settingsAsset.fieldIndexMap.push_back(cellIndex);
 
         const SettingsFieldType_e typeToUse = layoutAsset.rootLayout.typeMap[cellIndex];
@@ -669,17 +674,14 @@ static bool SettingsAsset_ParseMods(SettingsAssetHeader_s* const setHdr, const S
     return true;
 }
 
-extern void SettingsLayout_ParseLayout(CPakFileBuilder* const pak, const char* const assetPath, SettingsLayoutAsset_s& layoutAsset);
-
 static void SettingsAsset_InternalAddSettingsAsset(CPakFileBuilder* const pak, const PakGuid_t assetGuid, const char* const assetPath)
 {
-    rapidjson::Document settings;
-    SettingsAsset_OpenFile(pak, assetPath, settings);
+    const std::shared_ptr<const rapidjson::Document> settingsRef = SettingsAsset_OpenFile(pak, assetPath);
+    const rapidjson::Document& settings = *settingsRef;
 
     const char* const layoutAssetPath = JSON_GetValueRequired<const char*>(settings, "layoutAsset");
 
-    SettingsLayoutAsset_s layoutAsset;
-    SettingsLayout_ParseLayout(pak, layoutAssetPath, layoutAsset);
+    const SettingsLayoutAsset_s& layoutAsset = SettingsLayout_GetParsedLayout(pak, layoutAssetPath);
 
     PakAsset_t& asset = pak->BeginAsset(assetGuid, assetPath);
     PakPageLump_s hdrLump = pak->CreatePageLump(sizeof(SettingsAssetHeader_s), SF_HEAD, 8);
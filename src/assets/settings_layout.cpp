@@ -4,7 +4,14 @@
 
 // Maximum number of retries to find a good hashing configuration
 // with the least amount of collisions.
-#define SETTINGS_LAYOUT_MAX_HASH_RETRIES 128
+#define SETTINGS_LAYOUT_MAX_HASH_RETRIES 1024
+
+// Layouts with fewer fields than this are searched on the calling thread,
+// as the search is faster than spinning up the worker threads.
+#define SETTINGS_LAYOUT_MIN_FIELDS_FOR_PARALLEL_HASH 64
+
+// Maximum number of buckets; the runtime stores bucket indices as 16 bits.
+#define SETTINGS_LAYOUT_MAX_HASH_TABLE_SIZE 0x10000
 
 uint32_t SettingsLayout_GetFieldSizeForType(const SettingsFieldType_e type)
 {
@@ -197,14 +204,12 @@ bool SettingsFieldFinder_FindFieldByAbsoluteName(const SettingsLayoutAsset_s& la
         lookupName = lookupCapture.c_str();
     }
 
-    // Look the field name up.
-    for (size_t i = 0; i < layout.rootLayout.fieldNames.size(); i++)
-    {
-        const std::string& currFieldName = layout.rootLayout.fieldNames[i];
-
-        if (currFieldName.compare(lookupName) != 0)
-            continue;
+    // Look the field name up, the first occurrence is used.
+    const auto fieldIt = layout.rootLayout.fieldNameMap.find(lookupName);
 
+    if (fieldIt != layout.rootLayout.fieldNameMap.end())
+    {
+        const size_t i = fieldIt->second.front();
         const SettingsFieldType_e currFieldType = layout.rootLayout.typeMap[i];
         const uint32_t fieldOffset = layout.rootLayout.offsetMap[i];
 
@@ -284,82 +289,165 @@ static uint32_t SettingsFieldFinder_GetFieldNameBucket(const char* const name, c
     return hash & bucketMask;
 }
 
-static void SettingsLayout_ComputeHashParameters(SettingsLayoutParseResult_s& result)
+struct SettingsLayoutHashCandidate_s
 {
-    const size_t numFields = result.fieldNames.size();
+    // Lower is better; collisions are resolved through linear probing in the
+    // runtime, so the probe distances are what lookups actually pay for.
+    inline bool IsBetterThan(const SettingsLayoutHashCandidate_s& other) const
+    {
+        if (totalProbeDistance != other.totalProbeDistance)
+            return totalProbeDistance < other.totalProbeDistance;
 
-    const uint32_t numBuckets = static_cast<uint32_t>(NextPowerOfTwo(numFields + 1));
+        if (maxProbeDistance != other.maxProbeDistance)
+            return maxProbeDistance < other.maxProbeDistance;
+
+        // Keep the result deterministic regardless of the thread count.
+        return retryIndex < other.retryIndex;
+    }
+
+    uint32_t retryIndex;
+    uint32_t totalProbeDistance;
+    uint32_t maxProbeDistance;
+
+    std::vector<uint32_t> bucketMap;
+};
+
+static void SettingsLayout_EvaluateHashCandidate(const std::vector<std::string>& fieldNames, const uint32_t numBuckets,
+    const uint32_t retryIndex, std::vector<bool>& occupiedBuckets, SettingsLayoutHashCandidate_s& candidate)
+{
+    const uint32_t stepScale = retryIndex * 2 + 1;
+    const uint32_t seed = retryIndex;
     const uint32_t bucketMask = numBuckets - 1;
 
-    uint32_t bestStepScale = 1;
-    uint32_t bestSeed = 0;
-    uint32_t minCollisions = UINT32_MAX; // Track the minimum number of collisions.
+    const size_t numFields = fieldNames.size();
 
-    std::vector<uint32_t> bestBucketMap(numFields, 0);
+    occupiedBuckets.assign(numBuckets, false);
+    candidate.bucketMap.resize(numFields);
 
-    for (uint32_t retryCount = 0; retryCount < SETTINGS_LAYOUT_MAX_HASH_RETRIES; retryCount++)
+    candidate.retryIndex = retryIndex;
+    candidate.totalProbeDistance = 0;
+    candidate.maxProbeDistance = 0;
+
+    for (size_t i = 0; i < numFields; i++)
     {
-        const uint32_t currentStepScale = retryCount * 2 + 1;
-        const uint32_t currentSeed = retryCount;
+        const uint32_t bucket = SettingsFieldFinder_GetFieldNameBucket(fieldNames[i].c_str(), stepScale, seed, numBuckets);
+        uint32_t probeDistance = 0;
 
-        std::vector<bool> collisionVec(numBuckets, false);
-        std::vector<uint32_t> bucketMap(numFields, 0);
+        // Note(amos): collisions are expected, the game does linear
+        // probing to minimize the number of string comparisons while
+        // trying to solve these. We must place our field contiguously
+        // after the colliding bucket index, at the first free bucket
+        // as the lookup in SettingsFieldFinder_FindFieldByName() stops
+        // when it encounters an empty bucket.
+        while (occupiedBuckets[(bucket + probeDistance) & bucketMask])
+            probeDistance++;
 
-        uint32_t currentCollisions = 0;
+        const uint32_t curBucket = (bucket + probeDistance) & bucketMask;
 
-        for (size_t i = 0; i < numFields; i++)
-        {
-            const std::string& fieldName = result.fieldNames[i];
-            const uint32_t bucket = SettingsFieldFinder_GetFieldNameBucket(fieldName.c_str(), currentStepScale, currentSeed, numBuckets);
+        occupiedBuckets[curBucket] = true;
+        candidate.bucketMap[i] = curBucket;
 
-            if (collisionVec[bucket])
-            {
-                currentCollisions++;
-
-                // Note(amos): collisions are expected, the game does linear
-                // probing to minimize the number of string comparisons while
-                // trying to solve these. We must place our field contiguously
-                // after the colliding bucket index, at the first free bucket
-                // as the lookup in SettingsFieldFinder_FindFieldByName() stops
-                // when it encounters an empty bucket.
-                for (size_t j = 1; j < numBuckets; j++)
-                {
-                    const uint32_t curBucket = (bucket+j) & bucketMask;
+        candidate.totalProbeDistance += probeDistance;
 
-                    if (collisionVec[curBucket])
-                        continue;
+        if (probeDistance > candidate.maxProbeDistance)
+            candidate.maxProbeDistance = probeDistance;
+    }
+}
 
-                    collisionVec[curBucket] = true;
-                    bucketMap[i] = curBucket;
+static void SettingsLayout_FindBestHashCandidate(const std::vector<std::string>& fieldNames, const uint32_t numBuckets, SettingsLayoutHashCandidate_s& best)
+{
+    const uint32_t hardwareThreads = std::thread::hardware_concurrency();
+    const uint32_t numThreads = (fieldNames.size() < SETTINGS_LAYOUT_MIN_FIELDS_FOR_PARALLEL_HASH || hardwareThreads < 2)
+        ? 1
+        : (std::min)(hardwareThreads, 16u);
 
-                    break;
-                }
-            }
-            else
+    // Once a collision free candidate is found, higher retry indices can be
+    // skipped as they can't beat it anymore.
+    std::atomic<uint32_t> collisionFreeRetryIndex = UINT32_MAX;
+    std::vector<SettingsLayoutHashCandidate_s> threadBests(numThreads);
+
+    const auto searchWorker = [&](const uint32_t threadIndex)
+    {
+        SettingsLayoutHashCandidate_s& threadBest = threadBests[threadIndex];
+        threadBest.retryIndex = UINT32_MAX;
+
+        SettingsLayoutHashCandidate_s candidate;
+        std::vector<bool> occupiedBuckets;
+
+        for (uint32_t i = threadIndex; i < SETTINGS_LAYOUT_MAX_HASH_RETRIES; i += numThreads)
+        {
+            if (i > collisionFreeRetryIndex.load(std::memory_order_relaxed))
+                break;
+
+            SettingsLayout_EvaluateHashCandidate(fieldNames, numBuckets, i, occupiedBuckets, candidate);
+
+            if (threadBest.retryIndex == UINT32_MAX || candidate.IsBetterThan(threadBest))
+                std::swap(threadBest, candidate);
+
+            if (threadBest.totalProbeDistance == 0)
             {
-                collisionVec[bucket] = true;
-                bucketMap[i] = bucket;
+                uint32_t current = collisionFreeRetryIndex.load(std::memory_order_relaxed);
+
+                while (i < current && !collisionFreeRetryIndex.compare_exchange_weak(current, i, std::memory_order_relaxed))
+                    ;
+
+                break;
             }
         }
+    };
 
-        // Check if this configuration is better than the previous best.
-        if (currentCollisions < minCollisions)
-        {
-            minCollisions = currentCollisions;
-            bestStepScale = currentStepScale;
-            bestSeed = currentSeed;
+    if (numThreads == 1)
+        searchWorker(0);
+    else
+    {
+        std::vector<std::thread> workers;
+        workers.reserve(numThreads);
+
+        for (uint32_t i = 0; i < numThreads; i++)
+            workers.emplace_back(searchWorker, i);
+
+        for (std::thread& worker : workers)
+            worker.join();
+    }
+
+    best = std::move(threadBests[0]);
+
+    for (uint32_t i = 1; i < numThreads; i++)
+    {
+        if (threadBests[i].retryIndex != UINT32_MAX && threadBests[i].IsBetterThan(best))
+            best = std::move(threadBests[i]);
+    }
+}
+
+static void SettingsLayout_ComputeHashParameters(SettingsLayoutParseResult_s& result)
+{
+    const size_t numFields = result.fieldNames.size();
+    const uint32_t numBuckets = static_cast<uint32_t>(NextPowerOfTwo(numFields + 1));
+
+    SettingsLayoutHashCandidate_s best;
+    SettingsLayout_FindBestHashCandidate(result.fieldNames, numBuckets, best);
 
-            bestBucketMap = bucketMap;
+    uint32_t bestNumBuckets = numBuckets;
 
-            if (minCollisions == 0)
-                break; // No collisions at all, stop early.
+    // If we couldn't find a collision free configuration, try again with a
+    // table twice as large; only used when it removes all collisions as it
+    // costs an extra SettingsField_s per bucket.
+    if (best.totalProbeDistance > 0 && (numBuckets * 2) <= SETTINGS_LAYOUT_MAX_HASH_TABLE_SIZE)
+    {
+        SettingsLayoutHashCandidate_s larger;
+        SettingsLayout_FindBestHashCandidate(result.fieldNames, numBuckets * 2, larger);
+
+        if (larger.totalProbeDistance == 0)
+        {
+            best = std::move(larger);
+            bestNumBuckets = numBuckets * 2;
         }
     }
 
-    result.bucketMap = std::move(bestBucketMap);
-    result.hashTableSize = numBuckets;
-    result.hashStepScale = bestStepScale;
-    result.hashSeed = bestSeed;
+    result.bucketMap = std::move(best.bucketMap);
+    result.hashTableSize = bestNumBuckets;
+    result.hashStepScale = best.retryIndex * 2 + 1;
+    result.hashSeed = best.retryIndex;
 }
 
 static void SettingsLayout_ComputeHashParametersRecursive(SettingsLayoutAsset_s& layoutAsset)
@@ -408,6 +496,10 @@ static void SettingsLayout_ParseTable(CPakFileBuilder* const pak, const char* co
     }
 
     result.typeMap.resize(numTypeNames);
+    result.fieldNameMap.reserve(numFieldNames);
+
+    for (size_t i = 0; i < numFieldNames; i++)
+        result.fieldNameMap[result.fieldNames[i]].push_back(static_cast<uint32_t>(i));
 
     uint32_t lastUsedSublayout = 0;
     uint32_t numSubLayouts = 0;
@@ -590,10 +682,38 @@ static void SettingsLayout_BuildOffsetMap(SettingsLayoutAsset_s& layoutAsset)
     }
 }
 
-void SettingsLayout_ParseLayout(CPakFileBuilder* const pak, const char* const assetPath, SettingsLayoutAsset_s& layoutAsset)
+static void SettingsLayout_ParseLayout(CPakFileBuilder* const pak, const char* const assetPath, SettingsLayoutAsset_s& layoutAsset)
 {
     SettingsLayout_ParseMap(pak, assetPath, layoutAsset);
     SettingsLayout_BuildOffsetMap(layoutAsset);
+    SettingsLayout_ComputeHashParametersRecursive(layoutAsset);
+}
+
+// Parsed layouts, keyed by their path. A layout is typically shared by many
+// settings assets, so it is only parsed once per build. Error() throws instead
+// of exiting in keep-going builds, so a layout that fails to parse must not be
+// left behind in the cache for the next asset or pak to pick up.
+static std::unordered_map<std::string, SettingsLayoutAsset_s> s_settingsLayoutCache;
+
+const SettingsLayoutAsset_s& SettingsLayout_GetParsedLayout(CPakFileBuilder* const pak, const char* const assetPath)
+{
+    const auto [it, inserted] = s_settingsLayoutCache.try_emplace(pak->GetAssetPath() + assetPath);
+    SettingsLayoutAsset_s& layoutAsset = it->second;
+
+    if (!inserted)
+        return layoutAsset;
+
+    try
+    {
+        SettingsLayout_ParseLayout(pak, assetPath, layoutAsset);
+    }
+    catch (...)
+    {
+        s_settingsLayoutCache.erase(it);
+        throw;
+    }
+
+    return layoutAsset;
 }
 
 static void SettingsLayout_InitializeHeader(SettingsLayoutHeader_s* const header, const SettingsLayoutParseResult_s& parse)
@@ -757,14 +877,12 @@ static void SettingsLayout_WriteLayoutRecursive(CPakFileBuilder* const pak, Sett
 
 static void SettingsLayout_InternalAddLayoutAsset(CPakFileBuilder* const pak, const PakGuid_t assetGuid, const char* const assetPath)
 {
-    SettingsLayoutAsset_s layoutAsset;
-    SettingsLayout_ParseLayout(pak, assetPath, layoutAsset);
+    // Copied, as the buffer indices are stored in the layout while writing.
+    SettingsLayoutAsset_s layoutAsset = SettingsLayout_GetParsedLayout(pak, assetPath);
 
     PakAsset_t& asset = pak->BeginAsset(assetGuid, assetPath);
     PakPageLump_s hdrLump = pak->CreatePageLump(sizeof(SettingsLayoutHeader_s), SF_HEAD, 8);
 
-    SettingsLayout_ComputeHashParametersRecursive(layoutAsset);
-
     SettingsLayoutMemory_s layoutMemory{};
     size_t headersBufIndexer = 0;
 
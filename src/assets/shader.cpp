@@ -4,10 +4,85 @@
 #include "public/multishader.h"
 #include "utils/dxutils.h"
 
-static void Shader_LoadFromMSW(CPakFileBuilder* const pak, const char* const assetPath, CMultiShaderWrapperIO::ShaderCache_t& shaderCache)
+// MSW files are cached for the duration of the build, as the same file can be
+// referenced by multiple assets and paks. The shader entries reference the
+// bytecode in the mapped file, so the entry keeps it open. Entries that fail
+// to parse are removed again, as Error() throws in keep-going builds.
+struct ShaderMSWCacheEntry_s
+{
+	CMappedFile mappedFile;
+	CMultiShaderWrapperIO::ShaderCache_t shaderCache;
+};
+
+static std::unordered_map<std::string, ShaderMSWCacheEntry_s> s_mswCache;
+
+// Parsed RDEF data of the shaders in the MSW cache, so the bytecode of each
+// shader only gets parsed once, even if it is added to multiple paks.
+static std::unordered_map<const CMultiShaderWrapperIO::Shader_t*, ParsedDXShaderData_t> s_parsedShaderCache;
+
+//-----------------------------------------------------------------------------
+// Purpose: loads the MSW file of given asset, or returns the cached file if it
+//          has already been loaded during this build
+//-----------------------------------------------------------------------------
+const CMultiShaderWrapperIO::ShaderCache_t& Shader_GetCachedMSW(CPakFileBuilder* const pak, const char* const assetPath, const MultiShaderWrapperFileType_e expectType)
 {
 	const fs::path inputFilePath = pak->GetAssetPath() / fs::path(assetPath).replace_extension("msw");
-	MSW_ParseFile(inputFilePath, shaderCache, MultiShaderWrapperFileType_e::SHADER);
+	const auto [it, inserted] = s_mswCache.try_emplace(inputFilePath.string());
+
+	ShaderMSWCacheEntry_s& entry = it->second;
+
+	if (inserted)
+	{
+		try
+		{
+			MSW_ParseFile(inputFilePath, entry.mappedFile, entry.shaderCache, expectType);
+		}
+		catch (...)
+		{
+			s_mswCache.erase(it);
+			throw;
+		}
+	}
+	else if (entry.shaderCache.type != expectType)
+	{
+		Error("Attempted to load MSW file \"%s\" as %s while %s was expected.\n",
+			inputFilePath.string().c_str(),
+			MSW_TypeToString(entry.shaderCache.type), MSW_TypeToString(expectType));
+	}
+
+	return entry.shaderCache;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: parses the bytecode buffers of the shader until the RDEF chunk has
+//          been found, the result is cached per shader
+//-----------------------------------------------------------------------------
+static const ParsedDXShaderData_t& Shader_GetParsedData(const CMultiShaderWrapperIO::Shader_t* const shader)
+{
+	const auto [it, inserted] = s_parsedShaderCache.try_emplace(shader);
+	ParsedDXShaderData_t& parsedData = it->second;
+
+	if (inserted)
+	{
+		try
+		{
+			for (const auto& entry : shader->entries)
+			{
+				if (entry.buffer == nullptr)
+					continue;
+
+				if (DXUtils::GetParsedShaderData(entry.buffer, entry.size, &parsedData) && (parsedData.foundFlags & SHDR_FOUND_RDEF))
+					break;
+			}
+		}
+		catch (...)
+		{
+			s_parsedShaderCache.erase(it);
+			throw;
+		}
+	}
+
+	return parsedData;
 }
 
 template <typename ShaderAssetHeader_t>
@@ -19,36 +94,23 @@ static void Shader_CreateFromMSW(CPakFileBuilder* const pak, PakPageLump_s& cpuD
 
 	for (auto& it : shader->entries)
 	{
-		if (it.buffer == nullptr)
-			continue;
-
-		// If the shader type hasn't been found yet, parse this buffer and find out what we want to set it as.
-		if (hdr->type == eShaderType::Invalid)
-		{
-			if (DXUtils::GetParsedShaderData(it.buffer, it.size, firstShaderData))
-			{
-				if (firstShaderData->foundFlags & SHDR_FOUND_RDEF)
-				{
-					hdr->type = static_cast<eShaderType>(firstShaderData->pakShaderType);
-				}
-			}
-		}
-
-		totalShaderDataSize += IALIGN(it.size, 8);
+		if (it.buffer != nullptr)
+			totalShaderDataSize += it.size;
 	}
 	assert(totalShaderDataSize != 0);
 
+	// Find out what we want to set the shader type as from the first buffer
+	// that has an RDEF chunk.
+	*firstShaderData = Shader_GetParsedData(shader);
+
+	if (firstShaderData->foundFlags & SHDR_FOUND_RDEF)
+		hdr->type = static_cast<eShaderType>(firstShaderData->pakShaderType);
+
 	const int8_t entrySize = hdr->type == eShaderType::Vertex ? 24 : 16;
 
 	// Size of the data that describes each shader bytecode buffer
 	const size_t descriptorSize = numShaderBuffers * entrySize;
-
-	const size_t shaderBufferChunkSize = descriptorSize + totalShaderDataSize;
-	cpuDataChunk = pak->CreatePageLump(shaderBufferChunkSize, SF_CPU | SF_TEMP, 8);
-
-	// Offset at which the next bytecode buffer will be written.
-	// Initially starts at the end of the descriptors and then gets increased every time a buffer is written.
-	size_t nextBytecodeBufferOffset = descriptorSize;
+	cpuDataChunk = pak->CreatePageLump(descriptorSize, SF_CPU | SF_TEMP, 8);
 
 	for (size_t i = 0; i < numShaderBuffers; ++i)
 	{
@@ -60,18 +122,20 @@ static void Shader_CreateFromMSW(CPakFileBuilder* const pak, PakPageLump_s& cpuD
 		{
 			assert(entry.size > 0);
 
+			// Shader permutations are often shared between shaders and shader
+			// sets, so the bytecode is stored only once per pak and every
+			// descriptor with identical bytecode points to the same copy.
+			const PakPageLump_s bytecodeChunk = pak->CreateSharedPageLump(entry.buffer, entry.size, SF_CPU | SF_TEMP, 8);
+
 			// Register the data pointer at the byte code.
-			pak->AddPointer(cpuDataChunk, (i * entrySize) + offsetof(ShaderByteCode_t, data), cpuDataChunk, nextBytecodeBufferOffset);
+			pak->AddPointer(cpuDataChunk, (i * entrySize) + offsetof(ShaderByteCode_t, data), bytecodeChunk, 0);
 			bc->dataSize = entry.size;
 
 			if (hdr->type == eShaderType::Vertex)
 			{
-				pak->AddPointer(cpuDataChunk, (i * entrySize) + offsetof(ShaderByteCode_t, inputSignatureBlob), cpuDataChunk, nextBytecodeBufferOffset);
+				pak->AddPointer(cpuDataChunk, (i * entrySize) + offsetof(ShaderByteCode_t, inputSignatureBlob), bytecodeChunk, 0);
 				bc->inputSignatureBlobSize = bc->dataSize;
 			}
-
-			memcpy_s(cpuDataChunk.data + nextBytecodeBufferOffset, entry.size, entry.buffer, entry.size);
-			nextBytecodeBufferOffset += IALIGN(entry.size, 8);
 		}
 		else
 		{
@@ -198,17 +262,13 @@ bool Shader_AutoAddShader(CPakFileBuilder* const pak, const char* const assetPat
 void Assets::AddShaderAsset_v8(CPakFileBuilder* const pak, const PakGuid_t assetGuid, const char* const assetPath, const rapidjson::Value& mapEntry)
 {
 	UNUSED(mapEntry);
-	CMultiShaderWrapperIO::ShaderCache_t cache = {};
-
-	Shader_LoadFromMSW(pak, assetPath, cache);
+	const CMultiShaderWrapperIO::ShaderCache_t& cache = Shader_GetCachedMSW(pak, assetPath, MultiShaderWrapperFileType_e::SHADER);
 	Shader_AddShaderV8(pak, assetPath, cache.shader, assetGuid);
 }
 
 void Assets::AddShaderAsset_v12(CPakFileBuilder* const pak, const PakGuid_t assetGuid, const char* const assetPath, const rapidjson::Value& mapEntry)
 {
 	UNUSED(mapEntry);
-	CMultiShaderWrapperIO::ShaderCache_t cache = {};
-
-	Shader_LoadFromMSW(pak, assetPath, cache);
+	const CMultiShaderWrapperIO::ShaderCache_t& cache = Shader_GetCachedMSW(pak, assetPath, MultiShaderWrapperFileType_e::SHADER);
 	Shader_AddShaderV12(pak, assetPath, cache.shader, assetGuid);
 }
@@ -6,11 +6,7 @@
 #include "public/shader.h"
 #include "public/multishader.h"
 
-static void ShaderSet_LoadFromMSW(CPakFileBuilder* const pak, const char* const assetPath, CMultiShaderWrapperIO::ShaderCache_t& shaderCache)
-{
-	const fs::path inputFilePath = pak->GetAssetPath() / fs::path(assetPath).replace_extension("msw");
-	MSW_ParseFile(inputFilePath, shaderCache, MultiShaderWrapperFileType_e::SHADERSET);
-}
+extern const CMultiShaderWrapperIO::ShaderCache_t& Shader_GetCachedMSW(CPakFileBuilder* const pak, const char* const assetPath, const MultiShaderWrapperFileType_e expectType);
 
 template <typename ShaderSetAssetHeader_t>
 static void ShaderSet_SetInputSlots(ShaderSetAssetHeader_t* const hdr, PakAsset_t* const /*shader*/, const bool isVertexShader, const CMultiShaderWrapperIO::ShaderSet_t* const shaderSet, const int assetVersion)
@@ -133,8 +129,7 @@ void ShaderSet_InternalCreateSet(CPakFileBuilder* const pak, const char* const a
 template <typename ShaderSetAssetHeader_t>
 static void ShaderSet_InternalAddShaderSet(CPakFileBuilder* const pak, const PakGuid_t assetGuid, const char* const assetPath, const int assetVersion)
 {
-	CMultiShaderWrapperIO::ShaderCache_t cache = {};
-	ShaderSet_LoadFromMSW(pak, assetPath, cache);
+	const CMultiShaderWrapperIO::ShaderCache_t& cache = Shader_GetCachedMSW(pak, assetPath, MultiShaderWrapperFileType_e::SHADERSET);
 
 	ShaderSet_InternalCreateSet<ShaderSetAssetHeader_t>(pak, assetPath, &cache.shaderSet, assetGuid, assetVersion);
 }
@@ -42,11 +42,13 @@ static void Texture_ProcessMetaData(CPakFileBuilder* const pak, const char* cons
                                     TextureAssetHeader_t* const hdr, const int totalMipCount, std::vector<mipType_e>& streamLayout)
 {
     const std::string metaFilePath = Utils::ChangeExtension(pak->GetAssetPath() + assetPath, ".json");
-    rapidjson::Document document;
+    const std::shared_ptr<const rapidjson::Document> documentRef = JSON_GetCachedDocument(metaFilePath.c_str(), "texture metadata", false);
 
-    if (!JSON_ParseFromFile(metaFilePath.c_str(), "texture metadata", document, false))
+    if (!documentRef)
         return;
 
+    const rapidjson::Document& document = *documentRef;
+
     rapidjson::Value::ConstMemberIterator streamLayoutIt;
 
     if (JSON_GetIterator(document, TEXTURE_STREAM_LAYOUT_FIELD, streamLayoutIt))
@@ -5,11 +5,13 @@
 static void TextureList_InternalAdd(CPakFileBuilder* const pak, const PakGuid_t assetGuid, const char* const assetPath)
 {
 	const std::string txlsPath = Utils::ChangeExtension(pak->GetAssetPath() + assetPath, "json");
-	rapidjson::Document document;
+	const std::shared_ptr<const rapidjson::Document> documentRef = JSON_GetCachedDocument(txlsPath.c_str(), "texture list", false);
 
-	if (!JSON_ParseFromFile(txlsPath.c_str(), "texture list", document, false))
+	if (!documentRef)
 		Error("Failed to open texture_list asset \"%s\".\n", txlsPath.c_str());
 
+	const rapidjson::Document& document = *documentRef;
+
 	rapidjson::Value::ConstMemberIterator texturesIt;
 	JSON_GetRequired(document, "textures", JSONFieldType_e::kArray, texturesIt);
 
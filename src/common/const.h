@@ -5,3 +5,4 @@
 #define PF_KEEP_DEV 1 << 0 // whether or not to keep debugging information
 #define PF_KEEP_SERVER 1 << 1 // whether or not to keep server only data
 #define PF_KEEP_CLIENT 1 << 2 // whether or not to keep client only data
+#define PF_KEEP_GOING 1 << 3 // whether or not to carry on after asset errors to report all of them, the pak isn't written if any occurred
@@ -43,4 +43,15 @@ void CBuildSettings::Init(const js::Document& doc, const char* const buildMapFil
 		AddFlags(PF_KEEP_CLIENT);
 
 	g_showDebugLogs = JSON_GetValueOrDefault(doc, "showDebugInfo", false);
+
+	// Optionally write the build log to a file, next to the console output.
+	std::string logFilePath;
+
+	if (JSON_GetValue(doc, "logFile", logFilePath))
+	{
+		Utils::ResolvePath(logFilePath, m_buildMapPath);
+
+		if (!Logger_OpenLogFile(logFilePath.c_str()))
+			Warning("Failed to open log file \"%s\".\n", logFilePath.c_str());
+	}
 }
@@ -8,6 +8,10 @@
 #include "pakfile.h"
 #include "assets/assets.h"
 #include "utils/zstdutils.h"
+#include "utils/MurmurHash3.h"
+#include "utils/buildevents.h"
+
+#define SHARED_LUMP_HASH_SEED 0x2F6A1C93
 
 CPakFileBuilder::CPakFileBuilder(const CBuildSettings* const buildSettings, CStreamFileBuilder* const streamBuilder)
 {
@@ -36,37 +40,47 @@ static std::unordered_set<PakAssetHandler_s, PakAssetHasher_s> s_pakAssetHandler
 	{"Ptch", PakAssetScope_e::kAll, Assets::AddPatchAsset, Assets::AddPatchAsset}
 };
 
-void CPakFileBuilder::AddJSONAsset(const PakAssetHandler_s& assetHandler, const char* const assetPath, const rapidjson::Value& file)
+//-----------------------------------------------------------------------------
+// purpose: checks if assets of given scope are kept in this pak
+//-----------------------------------------------------------------------------
+bool CPakFileBuilder::IsAssetScopeKept(const PakAssetScope_e scope) const
 {
-	switch (assetHandler.assetScope)
+	switch (scope)
 	{
 	case PakAssetScope_e::kServerOnly:
-		if (!IsFlagSet(PF_KEEP_SERVER))
-			return;
-		break;
+		return IsFlagSet(PF_KEEP_SERVER);
 	case PakAssetScope_e::kClientOnly:
-		if (!IsFlagSet(PF_KEEP_CLIENT))
-			return;
-		break;
+		return IsFlagSet(PF_KEEP_CLIENT);
 	}
 
-	PakAssetAddFunc_t targetFunc = nullptr;
-	const uint16_t fileVersion = this->m_Header.fileVersion;
+	return true;
+}
 
+//-----------------------------------------------------------------------------
+// purpose: gets the asset type's callback for given pak version
+// returns: the callback, or null if the type isn't supported on this version
+//-----------------------------------------------------------------------------
+static PakAssetAddFunc_t Pak_GetAssetAddFunc(const PakAssetHandler_s& assetHandler, const uint16_t fileVersion)
+{
 	switch (fileVersion)
 	{
 	case 7:
-	{
-		targetFunc = assetHandler.func_r2;
-		break;
-	}
+		return assetHandler.func_r2;
 	case 8:
-	{
-		targetFunc = assetHandler.func_r5;
-		break;
-	}
+		return assetHandler.func_r5;
 	}
 
+	return nullptr;
+}
+
+void CPakFileBuilder::AddJSONAsset(const PakAssetHandler_s& assetHandler, const char* const assetPath, const rapidjson::Value& file)
+{
+	if (!IsAssetScopeKept(assetHandler.assetScope))
+		return;
+
+	const uint16_t fileVersion = this->m_Header.fileVersion;
+	const PakAssetAddFunc_t targetFunc = Pak_GetAssetAddFunc(assetHandler, fileVersion);
+
 	if (targetFunc)
 	{
 		Debug("Adding '%s' asset \"%s\".\n", assetHandler.assetType, assetPath);
@@ -99,6 +113,12 @@ void CPakFileBuilder::AddAsset(const rapidjson::Value& file)
 		Error("No path provided for an asset of type '%.4s'.\n", assetType);
 
 	g_currentAsset = assetPath;
+	BuildEvents_AssetStarted(assetPath, assetType);
+
+	const steady_clock::time_point start = high_resolution_clock::now();
+	const size_t pageDataStart = m_pageBuilder.GetDataSize();
+	const size_t streamDataStart = m_streamDataSize;
+
 	const auto it = s_pakAssetHandlers.find({ assetType });
 
 	if (it == s_pakAssetHandlers.end())
@@ -106,9 +126,232 @@ void CPakFileBuilder::AddAsset(const rapidjson::Value& file)
 	else
 		AddJSONAsset(*it, assetPath, file);
 
+	if (BuildEvents_IsEnabled())
+	{
+		const microseconds duration = duration_cast<microseconds>(high_resolution_clock::now() - start);
+
+		BuildEvents_AssetFinished(assetPath, assetType, duration.count(),
+			m_pageBuilder.GetDataSize() - pageDataStart, m_streamDataSize - streamDataStart);
+	}
+
 	g_currentAsset = nullptr;
 }
 
+// The result of checking an asset's map entry, see AddAssetsCollectErrors().
+struct PakAssetCheck_s
+{
+	const char* assetPath = nullptr;
+	const char* assetType = nullptr;
+	PakGuid_t guid = 0; // Null if the asset isn't kept in this pak.
+	bool passed = false;
+
+	std::string error; // Set if the check failed.
+};
+
+// Number of map entries it takes before they are checked on multiple threads.
+#define PAK_MIN_ASSETS_FOR_PARALLEL_CHECK 64
+
+//-----------------------------------------------------------------------------
+// purpose: checks the asset's map entry without building the asset
+// returns: the asset's guid, or null if the asset isn't kept in this pak
+//-----------------------------------------------------------------------------
+PakGuid_t CPakFileBuilder::ValidateAssetEntry(const rapidjson::Value& file) const
+{
+	const char* const assetType = JSON_GetValueOrDefault(file, "_type", static_cast<const char*>(nullptr));
+	const char* const assetPath = JSON_GetValueOrDefault(file, "_path", static_cast<const char*>(nullptr));
+
+	if (!assetType)
+		Error("No type provided for asset \"%s\".\n", assetPath ? assetPath : "(unknown)");
+
+	if (!assetPath)
+		Error("No path provided for an asset of type '%.4s'.\n", assetType);
+
+	const auto it = s_pakAssetHandlers.find({ assetType });
+
+	if (it == s_pakAssetHandlers.end())
+		Error("Unhandled asset type '%.4s' provided.\n", assetType);
+
+	if (!IsAssetScopeKept(it->assetScope))
+		return 0;
+
+	if (!Pak_GetAssetAddFunc(*it, GetVersion()))
+		Error("Asset type '%.4s' is not supported on pak version %hu.\n", it->assetType, GetVersion());
+
+	return Pak_GetGuidOverridable(file, assetPath);
+}
+
+//-----------------------------------------------------------------------------
+// purpose: adds all assets, but records the error of an asset that fails and
+//          carries on with the next one instead of exiting, so all errors can
+//          be reported at once. all map entries are checked first, including
+//          for guid collisions, and only the assets that pass are built.
+//-----------------------------------------------------------------------------
+void CPakFileBuilder::AddAssetsCollectErrors(const rapidjson::Value::ConstArray& files)
+{
+	const size_t numAssets = files.Size();
+	std::vector<PakAssetCheck_s> checks(numAssets);
+
+	const uint32_t hardwareThreads = std::thread::hardware_concurrency();
+	const uint32_t numThreads = (numAssets < PAK_MIN_ASSETS_FOR_PARALLEL_CHECK || hardwareThreads < 2)
+		? 1
+		: (std::min)(hardwareThreads, 16u);
+
+	// the map entries are checked independently of each other, the errors are
+	// recorded afterwards so they are reported in map order.
+	const auto checkWorker = [&](const uint32_t threadIndex)
+	{
+		// error collection and the current asset are per thread.
+		Logger_SetCollectErrors(true);
+
+		for (size_t i = threadIndex; i < numAssets; i += numThreads)
+		{
+			PakAssetCheck_s& check = checks[i];
+
+			check.assetPath = JSON_GetValueOrDefault(files[i], "_path", static_cast<const char*>(nullptr));
+			check.assetType = JSON_GetValueOrDefault(files[i], "_type", static_cast<const char*>(nullptr));
+			g_currentAsset = check.assetPath;
+
+			try
+			{
+				check.guid = ValidateAssetEntry(files[i]);
+				check.passed = true;
+			}
+			catch (const LogError_s& e)
+			{
+				check.error = e.message;
+			}
+
+			g_currentAsset = nullptr;
+		}
+
+		Logger_SetCollectErrors(false);
+	};
+
+	if (numThreads == 1)
+		checkWorker(0);
+	else
+	{
+		std::vector<std::thread> workers;
+		workers.reserve(numThreads);
+
+		for (uint32_t i = 0; i < numThreads; i++)
+			workers.emplace_back(checkWorker, i);
+
+		for (std::thread& worker : workers)
+			worker.join();
+	}
+
+	Logger_SetCollectErrors(true);
+
+	// map entry of each guid checked so far, to find collisions.
+	std::unordered_map<PakGuid_t, size_t> guidToIndex;
+
+	for (size_t i = 0; i < numAssets; i++)
+	{
+		PakAssetCheck_s& check = checks[i];
+
+		if (!check.passed)
+		{
+			RecordAssetError(check.assetPath, check.assetType, check.error);
+			continue;
+		}
+
+		if (!check.guid)
+			continue;
+
+		const auto [it, inserted] = guidToIndex.emplace(check.guid, i);
+
+		if (inserted)
+			continue;
+
+		const PakAssetCheck_s& match = checks[it->second];
+		g_currentAsset = check.assetPath;
+
+		try
+		{
+			if (strcmp(match.assetPath, check.assetPath) == 0)
+				Error("Asset \"%s\" was already listed at map entry #%zu!\n", check.assetPath, it->second);
+			else
+			{
+				Error("Asset \"%s\" has GUID %llX which collides with asset \"%s\" at map entry #%zu!\n",
+					check.assetPath, check.guid, match.assetPath, it->second);
+			}
+		}
+		catch (const LogError_s& e)
+		{
+			RecordAssetError(check.assetPath, check.assetType, e.message);
+			check.passed = false;
+		}
+
+		g_currentAsset = nullptr;
+	}
+
+	// the asset callbacks load their source files while writing into the
+	// pak's pages and the stream files, so these run one at a time.
+	for (size_t i = 0; i < numAssets; i++)
+	{
+		const PakAssetCheck_s& check = checks[i];
+
+		if (!check.passed)
+			continue;
+
+		const size_t numAddedAssets = m_assets.size();
+		const size_t streamDataSize = m_streamDataSize;
+
+		// the stream files and their cache are shared with the other paks in
+		// the build, so the streaming data of an asset is only written out
+		// once the asset is built.
+		m_streamBuilder->HoldWrites();
+
+		try
+		{
+			AddAsset(files[i]);
+			m_streamBuilder->CommitHeldWrites();
+		}
+		catch (const LogError_s& e)
+		{
+			RecordAssetError(check.assetPath, check.assetType, e.message);
+			m_streamBuilder->DiscardHeldWrites();
+
+			// drop the failed asset so the next one starts clean, the page
+			// data it already created is never written as the pak is discarded.
+			m_assets.erase(m_assets.begin() + numAddedAssets, m_assets.end());
+			m_streamDataSize = streamDataSize;
+			m_processingAsset = false;
+
+			g_currentAsset = nullptr;
+		}
+	}
+
+	Logger_SetCollectErrors(false);
+}
+
+//-----------------------------------------------------------------------------
+// purpose: records the error of an asset that is dropped from the pak, the
+//          asset also counts as done for the build event stream
+//-----------------------------------------------------------------------------
+void CPakFileBuilder::RecordAssetError(const char* const assetPath, const char* const assetType, const std::string& message)
+{
+	PakAssetError_s& error = m_assetErrors.emplace_back();
+
+	error.assetPath = assetPath ? assetPath : "(unknown)";
+	error.message = message;
+
+	BuildEvents_AssetFailed(assetPath, assetType);
+}
+
+//-----------------------------------------------------------------------------
+// purpose: prints all errors collected by AddAssetsCollectErrors() together
+//-----------------------------------------------------------------------------
+void CPakFileBuilder::ReportAssetErrors(const size_t numAssets) const
+{
+	Log("*** %zu of %zu assets failed to build for pak file \"%s\":\n",
+		m_assetErrors.size(), numAssets, m_pakFilePath.c_str());
+
+	for (const PakAssetError_s& error : m_assetErrors)
+		Log("\t%s: %s", error.assetPath.c_str(), error.message.c_str());
+}
+
 //-----------------------------------------------------------------------------
 // purpose: adds page pointer to the pak file
 //-----------------------------------------------------------------------------
@@ -165,23 +408,15 @@ int64_t CPakFileBuilder::AddStreamingFileReference(const char* const path, const
 //-----------------------------------------------------------------------------
 PakStreamSetEntry_s CPakFileBuilder::AddStreamingDataEntry(const int64_t size, const uint8_t* const data, const PakStreamSet_e set)
 {
-	const size_t pageAligned = IALIGN(size, STARPAK_DATABLOCK_ALIGNMENT);
-	const size_t windowRemainder = pageAligned - size;
-
-	if (windowRemainder > 0)
-	{
-		// Code bug, data must always be provided with size aligned to
-		// STARPAK_DATABLOCK_ALIGNMENT as otherwise the de-duplication
-		// code will not work. starpak data is always page aligned. We
-		// will still continue to store the data as it will get padded
-		// out in the stream file builder within the file itself.
-		Warning("%s: didn't receive enough window for page alignment! [%zu < %zu].\n",
-			__FUNCTION__, size, pageAligned);
-		assert(0);
-	}
-
+	// note: the data doesn't need to be provided with its size aligned to
+	// STARPAK_DATABLOCK_ALIGNMENT, the stream file builder pads it out and
+	// hashes it as if it was padded so the de-duplication still works.
 	StreamAddEntryResults_s results;
-	m_streamBuilder->AddStreamingDataEntry(size, data, set, results);
+
+	if (m_streamBuilder->AddStreamingDataEntry(size, data, set, results))
+		m_streamDataSize += IALIGN(size, STARPAK_DATABLOCK_ALIGNMENT);
+	else
+		BuildEvents_StreamDedup(g_currentAsset, Pak_StreamSetToName(set), results.streamFile, size);
 
 	PakStreamSetEntry_s block;
 
@@ -421,6 +656,41 @@ PakPageLump_s CPakFileBuilder::CreatePageLump(const size_t size, const int flags
 	return m_pageBuilder.CreatePageLump(static_cast<int>(size), flags, alignment, buf);
 }
 
+//-----------------------------------------------------------------------------
+// purpose: creates a page lump holding a copy of given data, or returns an
+//          existing lump if identical data was already added to this pak with
+//          the same flags and alignment. the returned lump must be treated as
+//          read only, as it can be referenced by multiple assets.
+// returns: the lump containing the data at offset 0
+//-----------------------------------------------------------------------------
+PakPageLump_s CPakFileBuilder::CreateSharedPageLump(const void* const data, const size_t size, const int flags, const int alignment)
+{
+	uint64_t hash[2];
+	MurmurHash3_x64_128(data, size, SHARED_LUMP_HASH_SEED, hash);
+
+	const auto range = m_sharedLumps.equal_range(hash[0]);
+
+	for (auto it = range.first; it != range.second; ++it)
+	{
+		const PakSharedLump_s& shared = it->second;
+
+		if (shared.flags != flags || shared.lump.alignment != alignment || static_cast<size_t>(shared.lump.size) != size)
+			continue;
+
+		if (memcmp(shared.lump.data, data, size) != 0)
+			continue;
+
+		m_sharedLumpSavedBytes += size;
+		return shared.lump;
+	}
+
+	PakPageLump_s lump = CreatePageLump(size, flags, alignment);
+	memcpy(lump.data, data, size);
+
+	m_sharedLumps.emplace(hash[0], PakSharedLump_s{ lump, flags });
+	return lump;
+}
+
 //-----------------------------------------------------------------------------
 // purpose: 
 // returns: 
@@ -444,13 +714,37 @@ PakAsset_t* CPakFileBuilder::GetAssetByGuid(const PakGuid_t guid, size_t* const
 	return nullptr;
 }
 
+//-----------------------------------------------------------------------------
+// Purpose: loads a zstd dictionary trained with -traindict from disk
+//-----------------------------------------------------------------------------
+void Pak_LoadCompressDictionary(const char* const dictPath, std::vector<uint8_t>& outDict)
+{
+	BinaryIO dictFile;
+
+	if (!dictFile.Open(dictPath, BinaryIO::Mode_e::Read))
+		Error("Failed to open compression dictionary \"%s\".\n", dictPath);
+
+	const size_t dictSize = static_cast<size_t>(dictFile.GetSize());
+
+	outDict.resize(dictSize);
+	dictFile.Read(outDict.data(), dictSize);
+
+	if (ZDICT_getDictID(outDict.data(), dictSize) == 0)
+		Error("Compression dictionary \"%s\" is not a valid zstd dictionary.\n", dictPath);
+}
+
 //-----------------------------------------------------------------------------
 // Purpose: initialize pak encoder context
 // 
 // note(amos): unlike the pak file header, the zstd frame header needs to know
 // the uncompressed size without the file header.
+//
+// the frames of a seekable pak only cover part of the data, writing their size
+// would make decoders that size their output from the first frame header see a
+// truncated pak. their content size is left unknown instead, the seek table
+// still lists it for our own decoder.
 //-----------------------------------------------------------------------------
-static bool Pak_InitEncoderContext(ZSTD_CCtx* const cctx, const size_t uncompressedBlockSize, const int compressLevel, const int workerCount)
+static bool Pak_InitEncoderContext(ZSTD_CCtx* const cctx, const size_t uncompressedBlockSize, const bool writeContentSize, const PakEncodeSettings_s& settings)
 {
 	ZSTD_CCtx_reset(cctx, ZSTD_reset_session_only);
 	size_t result = ZSTD_CCtx_setPledgedSrcSize(cctx, uncompressedBlockSize);
@@ -461,76 +755,148 @@ static bool Pak_InitEncoderContext(ZSTD_CCtx* const cctx, const size_t uncompres
 		return false;
 	}
 
-	result = ZSTD_CCtx_setParameter(cctx, ZSTD_c_compressionLevel, compressLevel);
+	result = ZSTD_CCtx_setParameter(cctx, ZSTD_c_contentSizeFlag, writeContentSize ? 1 : 0);
 
 	if (ZSTD_isError(result))
 	{
-		Warning("Failed to set compression level %i: [%s].\n", compressLevel, ZSTD_getErrorName(result));
+		Warning("Failed to %s content size flag: [%s].\n", writeContentSize ? "set" : "clear", ZSTD_getErrorName(result));
 		return false;
 	}
 
-	result = ZSTD_CCtx_setParameter(cctx, ZSTD_c_nbWorkers, workerCount);
+	result = ZSTD_CCtx_setParameter(cctx, ZSTD_c_compressionLevel, settings.compressLevel);
 
 	if (ZSTD_isError(result))
 	{
-		Warning("Failed to set worker count %i: [%s].\n", workerCount, ZSTD_getErrorName(result));
+		Warning("Failed to set compression level %i: [%s].\n", settings.compressLevel, ZSTD_getErrorName(result));
 		return false;
 	}
 
-	return true;
-}
+	result = ZSTD_CCtx_setParameter(cctx, ZSTD_c_nbWorkers, settings.workerCount);
 
-static ZSTDEncoder_s s_zstdPakEncoder;
+	if (ZSTD_isError(result))
+	{
+		Warning("Failed to set worker count %i: [%s].\n", settings.workerCount, ZSTD_getErrorName(result));
+		return false;
+	}
 
-//-----------------------------------------------------------------------------
-// Purpose: stream encode pak file with given level and worker count
-// TODO: support Oodle stream to stream compress
-//-----------------------------------------------------------------------------
-static bool Pak_StreamToStreamEncode(BinaryIO& inStream, BinaryIO& outStream, const size_t headerSize, const int compressLevel, const int workerCount)
-{
-	// only the data past the main header gets compressed.
-	const size_t decodedFrameSize = (static_cast<size_t>(inStream.GetSize()) - headerSize);
+	result = ZSTD_CCtx_setParameter(cctx, ZSTD_c_windowLog, settings.windowLog);
 
-	if (!decodedFrameSize)
+	if (ZSTD_isError(result))
 	{
-		Warning("%s: pak file contains no data to be compressed.\n", __FUNCTION__);
+		Warning("Failed to set window log %i: [%s].\n", settings.windowLog, ZSTD_getErrorName(result));
 		return false;
 	}
 
-	if (!Pak_InitEncoderContext(&s_zstdPakEncoder.cctx, decodedFrameSize, compressLevel, workerCount))
+	result = ZSTD_CCtx_setParameter(cctx, ZSTD_c_strategy, settings.strategy);
+
+	if (ZSTD_isError(result))
 	{
+		Warning("Failed to set strategy %i: [%s].\n", settings.strategy, ZSTD_getErrorName(result));
 		return false;
 	}
 
-	const size_t buffInSize = ZSTD_CStreamInSize();
-	std::unique_ptr<uint8_t[]> buffInPtr(new uint8_t[buffInSize]);
+	result = ZSTD_CCtx_setParameter(cctx, ZSTD_c_jobSize, static_cast<int>(settings.jobSize));
 
-	if (!buffInPtr)
+	if (ZSTD_isError(result))
 	{
-		Warning("%s: failed to allocate input stream buffer of size %zu.\n", __FUNCTION__, buffInSize);
+		Warning("Failed to set job size %zu: [%s].\n", settings.jobSize, ZSTD_getErrorName(result));
 		return false;
 	}
 
-	const size_t buffOutSize = ZSTD_CStreamOutSize();
-	std::unique_ptr<uint8_t[]> buffOutPtr(new uint8_t[buffOutSize]);
+	result = ZSTD_CCtx_setParameter(cctx, ZSTD_c_enableLongDistanceMatching, settings.longDistance ? ZSTD_ps_enable : ZSTD_ps_disable);
 
-	if (!buffOutPtr)
+	if (ZSTD_isError(result))
 	{
-		Warning("%s: failed to allocate output stream buffer of size %zu.\n", __FUNCTION__, buffOutSize);
+		Warning("Failed to %s long distance matching: [%s].\n", settings.longDistance ? "enable" : "disable", ZSTD_getErrorName(result));
 		return false;
 	}
 
-	void* const buffIn = buffInPtr.get();
-	void* const buffOut = buffOutPtr.get();
+	return true;
+}
 
-	inStream.SeekGet(headerSize);
-	outStream.SeekPut(headerSize);
+static ZSTDEncoder_s s_zstdPakEncoder;
 
-	size_t bytesLeft = decodedFrameSize;
+//-----------------------------------------------------------------------------
+// Output of the stream encoder. When encoding in place, the output stream is a
+// second handle to the input file; output that would overwrite data that has
+// not been read yet is held back in memory until the input moved past it. The
+// output trails the input by far, except for incompressible data where it can
+// run ahead by a few bytes per block.
+//-----------------------------------------------------------------------------
+class CPakEncodeOutput
+{
+public:
+	CPakEncodeOutput(BinaryIO& outStream, BinaryIO* const inPlaceInput)
+		: m_outStream(outStream), m_inPlaceInput(inPlaceInput), m_writePos(outStream.TellPut()) {}
+
+	void Write(const void* const data, const size_t size)
+	{
+		const uint8_t* const bytes = reinterpret_cast<const uint8_t*>(data);
+
+		if (!m_inPlaceInput)
+		{
+			m_outStream.Write(bytes, size);
+			m_writePos += size;
+
+			return;
+		}
+
+		const std::streamoff readPos = m_inPlaceInput->TellGet();
+
+		if (m_heldBack.empty() && m_writePos + static_cast<std::streamoff>(size) <= readPos)
+		{
+			m_outStream.Write(bytes, size);
+			m_writePos += size;
+
+			return;
+		}
+
+		m_heldBack.insert(m_heldBack.end(), bytes, bytes + size);
+
+		if (readPos > m_writePos)
+			WriteHeldBack((std::min)(static_cast<size_t>(readPos - m_writePos), m_heldBack.size()));
+	}
+
+	template<typename T>
+	inline void Write(const T& value) { Write(&value, sizeof(value)); }
+
+	// writes out everything that was held back, the input must be fully read.
+	inline void Flush() { WriteHeldBack(m_heldBack.size()); }
+
+	// position of the next byte, including the data that is held back.
+	inline std::streamoff Tell() const { return m_writePos + static_cast<std::streamoff>(m_heldBack.size()); }
+
+private:
+	void WriteHeldBack(const size_t count)
+	{
+		if (!count)
+			return;
+
+		m_outStream.Write(m_heldBack.data(), count);
+		m_heldBack.erase(m_heldBack.begin(), m_heldBack.begin() + count);
+
+		m_writePos += count;
+	}
+
+	BinaryIO& m_outStream;
+	BinaryIO* const m_inPlaceInput;
+
+	std::streamoff m_writePos;
+	std::vector<uint8_t> m_heldBack;
+};
+
+//-----------------------------------------------------------------------------
+// Purpose: stream encode frameSize bytes from the current position of the
+//          input stream into a single zstd frame
+//-----------------------------------------------------------------------------
+static bool Pak_StreamToStreamEncodeFrame(BinaryIO& inStream, CPakEncodeOutput& output, const size_t frameSize,
+	void* const buffIn, const size_t buffInSize, void* const buffOut, const size_t buffOutSize)
+{
+	size_t bytesLeft = frameSize;
 
 	while (bytesLeft)
 	{
-		const bool lastChunk = (bytesLeft < buffInSize);
+		const bool lastChunk = (bytesLeft <= buffInSize);
 		const size_t numBytesToRead = lastChunk ? bytesLeft : buffInSize;
 
 		inStream.Read(reinterpret_cast<uint8_t*>(buffIn), numBytesToRead);
@@ -547,43 +913,465 @@ static bool Pak_StreamToStreamEncode(BinaryIO& inStream, BinaryIO& outStream, co
 			if (ZSTD_isError(remaining))
 			{
 				Warning("Failed to compress stream at %zd to stream at %zd: [%s].\n",
-					inStream.TellGet(), outStream.TellPut(), ZSTD_getErrorName(remaining));
+					inStream.TellGet(), output.Tell(), ZSTD_getErrorName(remaining));
 
 				return false;
 			}
 
-			outStream.Write(reinterpret_cast<uint8_t*>(buffOut), outputFrame.pos);
+			output.Write(buffOut, outputFrame.pos);
 
 			finished = lastChunk ? (remaining == 0) : (inputFrame.pos == inputFrame.size);
 		} while (!finished);
+
+		if (BuildEvents_IsEnabled())
+			BuildEvents_CompressProgress(inStream.TellGet(), inStream.GetSize(), output.Tell());
 	}
 
 	return true;
 }
 
-static bool Pak_InitDecoderContext(ZSTD_DCtx* const dctx)
+//-----------------------------------------------------------------------------
+// Purpose: writes the seek table of the zstd seekable format
+//-----------------------------------------------------------------------------
+static void Pak_WriteSeekTable(CPakEncodeOutput& output, const std::vector<ZSTDSeekTableEntry_s>& seekTable)
 {
-	ZSTD_DCtx_reset(dctx, ZSTD_reset_session_only);
-	return true;
-}
+	const size_t tableSize = seekTable.size() * sizeof(ZSTDSeekTableEntry_s) + sizeof(ZSTDSeekTableFooter_s);
 
-static ZSTDDecoder_s s_zstdPakDecoder;
+	output.Write(static_cast<uint32_t>(ZSTD_SEEKABLE_SKIPPABLE_MAGIC));
+	output.Write(static_cast<uint32_t>(tableSize));
+
+	output.Write(seekTable.data(), seekTable.size() * sizeof(ZSTDSeekTableEntry_s));
 
-static bool Pak_StreamToStreamDecode(BinaryIO& inStream, BinaryIO& outStream, const size_t headerSize)
+	ZSTDSeekTableFooter_s footer;
+
+	footer.numFrames = static_cast<uint32_t>(seekTable.size());
+	footer.descriptor = 0; // No checksums.
+	footer.seekableMagic = ZSTD_SEEKABLE_MAGICNUMBER;
+
+	output.Write(footer);
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: stream encode pak file with given settings. if a frame size is set,
+//          the data is encoded as independent frames followed by a seek table,
+//          which is still a valid zstd stream for regular stream decoders. if
+//          encoding in place, the output stream is a second handle to the
+//          input file
+// TODO: support Oodle stream to stream compress
+//-----------------------------------------------------------------------------
+static bool Pak_StreamToStreamEncode(BinaryIO& inStream, BinaryIO& outStream, const size_t headerSize, const PakEncodeSettings_s& settings, const bool inPlace)
 {
 	// only the data past the main header gets compressed.
-	const size_t encodedFrameSize = (static_cast<size_t>(inStream.GetSize()) - headerSize);
+	const size_t decodedFrameSize = (static_cast<size_t>(inStream.GetSize()) - headerSize);
 
-	if (!encodedFrameSize)
+	if (!decodedFrameSize)
 	{
-		Warning("%s: pak file contains no data to be decompressed.\n", __FUNCTION__);
+		Warning("%s: pak file contains no data to be compressed.\n", __FUNCTION__);
 		return false;
 	}
 
-	if (!Pak_InitDecoderContext(&s_zstdPakDecoder.dctx))
-	{
-		return false;
-	}
+	BuildEvents_CompressStarted();
+
+	const size_t buffInSize = ZSTD_CStreamInSize();
+	std::unique_ptr<uint8_t[]> buffInPtr(new uint8_t[buffInSize]);
+
+	if (!buffInPtr)
+	{
+		Warning("%s: failed to allocate input stream buffer of size %zu.\n", __FUNCTION__, buffInSize);
+		return false;
+	}
+
+	const size_t buffOutSize = ZSTD_CStreamOutSize();
+	std::unique_ptr<uint8_t[]> buffOutPtr(new uint8_t[buffOutSize]);
+
+	if (!buffOutPtr)
+	{
+		Warning("%s: failed to allocate output stream buffer of size %zu.\n", __FUNCTION__, buffOutSize);
+		return false;
+	}
+
+	void* const buffIn = buffInPtr.get();
+	void* const buffOut = buffOutPtr.get();
+
+	// the dictionary persists across the session resets of each frame, an
+	// empty one clears the dictionary used by the previous pak.
+	std::vector<uint8_t> dict;
+
+	if (!settings.dictPath.empty())
+		Pak_LoadCompressDictionary(settings.dictPath.c_str(), dict);
+
+	ZSTD_CCtx_reset(&s_zstdPakEncoder.cctx, ZSTD_reset_session_only);
+	const size_t dictResult = ZSTD_CCtx_loadDictionary(&s_zstdPakEncoder.cctx, dict.data(), dict.size());
+
+	if (ZSTD_isError(dictResult))
+	{
+		Warning("Failed to load compression dictionary \"%s\": [%s].\n", settings.dictPath.c_str(), ZSTD_getErrorName(dictResult));
+		return false;
+	}
+
+	inStream.SeekGet(headerSize);
+	outStream.SeekPut(headerSize);
+
+	CPakEncodeOutput output(outStream, inPlace ? &inStream : nullptr);
+
+	const bool seekable = settings.frameSize > 0;
+	const size_t frameSize = seekable ? settings.frameSize : decodedFrameSize;
+
+	std::vector<ZSTDSeekTableEntry_s> seekTable;
+
+	if (seekable)
+		seekTable.reserve((decodedFrameSize + frameSize - 1) / frameSize);
+
+	size_t bytesLeft = decodedFrameSize;
+
+	while (bytesLeft)
+	{
+		const size_t frameDecodedSize = (std::min)(bytesLeft, frameSize);
+
+		// only a frame that holds all of the data may state its size.
+		const bool writeContentSize = (frameDecodedSize == decodedFrameSize);
+
+		if (!Pak_InitEncoderContext(&s_zstdPakEncoder.cctx, frameDecodedSize, writeContentSize, settings))
+			return false;
+
+		const std::streamoff frameStart = output.Tell();
+
+		if (!Pak_StreamToStreamEncodeFrame(inStream, output, frameDecodedSize, buffIn, buffInSize, buffOut, buffOutSize))
+			return false;
+
+		if (seekable)
+		{
+			ZSTDSeekTableEntry_s& entry = seekTable.emplace_back();
+
+			entry.compressedSize = static_cast<uint32_t>(output.Tell() - frameStart);
+			entry.decompressedSize = static_cast<uint32_t>(frameDecodedSize);
+		}
+
+		bytesLeft -= frameDecodedSize;
+	}
+
+	if (seekable)
+		Pak_WriteSeekTable(output, seekTable);
+
+	output.Flush();
+	return true;
+}
+
+static bool Pak_InitDecoderContext(ZSTD_DCtx* const dctx, const ZSTD_DDict* const ddict)
+{
+	ZSTD_DCtx_reset(dctx, ZSTD_reset_session_only);
+
+	// a null dictionary returns the context to no-dictionary mode.
+	const size_t result = ZSTD_DCtx_refDDict(dctx, ddict);
+
+	if (ZSTD_isError(result))
+	{
+		Warning("Failed to reference decompression dictionary: [%s].\n", ZSTD_getErrorName(result));
+		return false;
+	}
+
+	return true;
+}
+
+static ZSTDDecoder_s s_zstdPakDecoder;
+
+//-----------------------------------------------------------------------------
+// Purpose: reads the seek table of the zstd seekable format, if the encoded
+//          data has one. the frame sizes are used to size the decode buffers,
+//          so the table is only used if the frames add up to the decoded size
+//          in the pak header
+//-----------------------------------------------------------------------------
+static bool Pak_ReadSeekTable(BinaryIO& inStream, const size_t headerSize, const size_t decodedSize, std::vector<ZSTDSeekTableEntry_s>& outSeekTable)
+{
+	const size_t fileSize = static_cast<size_t>(inStream.GetSize());
+	const size_t encodedSize = fileSize - headerSize;
+
+	if (encodedSize < ZSTD_SKIPPABLEHEADERSIZE + sizeof(ZSTDSeekTableFooter_s))
+		return false;
+
+	ZSTDSeekTableFooter_s footer;
+
+	inStream.SeekGet(fileSize - sizeof(ZSTDSeekTableFooter_s));
+	inStream.Read(footer);
+
+	if (footer.seekableMagic != ZSTD_SEEKABLE_MAGICNUMBER)
+		return false;
+
+	// checksums follow each entry if the flag is set, we don't use them.
+	const size_t entrySize = sizeof(ZSTDSeekTableEntry_s) + ((footer.descriptor & ZSTD_SEEKABLE_CHECKSUM_FLAG) ? sizeof(uint32_t) : 0);
+	const size_t tableSize = ZSTD_SKIPPABLEHEADERSIZE + (footer.numFrames * entrySize) + sizeof(ZSTDSeekTableFooter_s);
+
+	if (tableSize > encodedSize)
+		return false;
+
+	inStream.SeekGet(fileSize - tableSize);
+
+	const uint32_t skippableMagic = inStream.Read<uint32_t>();
+	const uint32_t skippableSize = inStream.Read<uint32_t>();
+
+	if (skippableMagic != ZSTD_SEEKABLE_SKIPPABLE_MAGIC || skippableSize != tableSize - ZSTD_SKIPPABLEHEADERSIZE)
+		return false;
+
+	outSeekTable.resize(footer.numFrames);
+
+	size_t totalCompressedSize = 0;
+	size_t totalDecompressedSize = 0;
+
+	for (ZSTDSeekTableEntry_s& entry : outSeekTable)
+	{
+		inStream.Read(entry);
+
+		if (entrySize > sizeof(ZSTDSeekTableEntry_s))
+			inStream.Read<uint32_t>();
+
+		if (entry.decompressedSize > ZSTD_SEEKABLE_MAX_FRAME_SIZE)
+			return false;
+
+		totalCompressedSize += entry.compressedSize;
+		totalDecompressedSize += entry.decompressedSize;
+	}
+
+	// the frames must span the entire encoded data, else this isn't ours.
+	if (totalCompressedSize != encodedSize - tableSize)
+		return false;
+
+	if (headerSize + totalDecompressedSize != decodedSize)
+	{
+		Warning("Seek table frames decode to %zu bytes while the pak header expects a %zu byte pak; ignoring the seek table.\n",
+			totalDecompressedSize, decodedSize);
+
+		return false;
+	}
+
+	return true;
+}
+
+// Maximum amount of encoded plus decoded data held in memory by a batch of
+// frames decoded in parallel; a single frame larger than this still gets
+// decoded on its own.
+#define PAK_DECODE_BATCH_MAX_SIZE (256ull * 1024 * 1024)
+
+//-----------------------------------------------------------------------------
+// Purpose: decodes the independent frames listed in the seek table in
+//          parallel, in batches of at most one frame per worker and
+//          PAK_DECODE_BATCH_MAX_SIZE bytes. if decoding in place, the batches
+//          are decoded back to front, so the decoded data of each batch only
+//          overwrites encoded data that was read already
+//-----------------------------------------------------------------------------
+static bool Pak_StreamToStreamDecodeFrames(BinaryIO& inStream, BinaryIO& outStream, const size_t headerSize,
+	const std::vector<ZSTDSeekTableEntry_s>& seekTable, const ZSTD_DDict* const ddict, const bool inPlace)
+{
+	const size_t numFrames = seekTable.size();
+	const size_t numWorkers = std::clamp(static_cast<size_t>(std::thread::hardware_concurrency()), size_t(1), (std::max)(numFrames, size_t(1)));
+
+	// offsets of each frame in the encoded and decoded data, plus the end.
+	std::vector<size_t> encodedOffsets(numFrames + 1, headerSize);
+	std::vector<size_t> decodedOffsets(numFrames + 1, headerSize);
+
+	for (size_t i = 0; i < numFrames; i++)
+	{
+		encodedOffsets[i + 1] = encodedOffsets[i] + seekTable[i].compressedSize;
+		decodedOffsets[i + 1] = decodedOffsets[i] + seekTable[i].decompressedSize;
+	}
+
+	// first frame of each batch, plus the end.
+	std::vector<size_t> batchStarts(1, 0);
+
+	while (batchStarts.back() < numFrames)
+	{
+		const size_t batchStart = batchStarts.back();
+		size_t batchEnd = batchStart + 1;
+
+		while (batchEnd < numFrames && batchEnd - batchStart < numWorkers)
+		{
+			const size_t batchSize = (encodedOffsets[batchEnd + 1] - encodedOffsets[batchStart])
+				+ (decodedOffsets[batchEnd + 1] - decodedOffsets[batchStart]);
+
+			if (batchSize > PAK_DECODE_BATCH_MAX_SIZE)
+				break;
+
+			batchEnd++;
+		}
+
+		batchStarts.push_back(batchEnd);
+	}
+
+	const size_t numBatches = batchStarts.size() - 1;
+
+	std::unique_ptr<ZSTDDecoder_s[]> decoders(new ZSTDDecoder_s[numWorkers]);
+
+	std::vector<uint8_t> encodedBatch;
+	std::vector<uint8_t> decodedBatch;
+
+	std::vector<size_t> frameResults(numWorkers);
+	std::vector<std::thread> workers;
+
+	for (size_t batch = 0; batch < numBatches; batch++)
+	{
+		const size_t batchIndex = inPlace ? (numBatches - 1 - batch) : batch;
+
+		const size_t batchStart = batchStarts[batchIndex];
+		const size_t batchEnd = batchStarts[batchIndex + 1];
+
+		const size_t encodedBatchSize = encodedOffsets[batchEnd] - encodedOffsets[batchStart];
+		const size_t decodedBatchSize = decodedOffsets[batchEnd] - decodedOffsets[batchStart];
+
+		// frames are stored back to back, so the batch is read in one go.
+		encodedBatch.resize(encodedBatchSize);
+		decodedBatch.resize(decodedBatchSize);
+
+		inStream.SeekGet(encodedOffsets[batchStart]);
+		inStream.Read(encodedBatch.data(), encodedBatchSize);
+
+		for (size_t i = batchStart; i < batchEnd; i++)
+		{
+			const ZSTDSeekTableEntry_s& entry = seekTable[i];
+			const size_t workerIndex = i - batchStart;
+
+			uint8_t* const dst = &decodedBatch[decodedOffsets[i] - decodedOffsets[batchStart]];
+			const uint8_t* const src = &encodedBatch[encodedOffsets[i] - encodedOffsets[batchStart]];
+
+			workers.emplace_back([&decoders, &frameResults, workerIndex, dst, dstSize = entry.decompressedSize, src, srcSize = entry.compressedSize, ddict]()
+				{
+					ZSTD_DCtx* const dctx = &decoders[workerIndex].dctx;
+					Pak_InitDecoderContext(dctx, ddict);
+
+					frameResults[workerIndex] = ZSTD_decompressDCtx(dctx, dst, dstSize, src, srcSize);
+				});
+		}
+
+		for (std::thread& worker : workers)
+			worker.join();
+
+		workers.clear();
+
+		for (size_t i = batchStart; i < batchEnd; i++)
+		{
+			const size_t result = frameResults[i - batchStart];
+
+			if (ZSTD_isError(result))
+			{
+				Error("Failed to decompress frame #%zu: [%s].\n", i, ZSTD_getErrorName(result));
+				return false;
+			}
+
+			if (result != seekTable[i].decompressedSize)
+			{
+				Error("Failed to decompress frame #%zu; decoded %zu bytes while the seek table expected %u bytes.\n",
+					i, result, seekTable[i].decompressedSize);
+
+				return false;
+			}
+		}
+
+		outStream.SeekPut(decodedOffsets[batchStart]);
+		outStream.Write(decodedBatch.data(), decodedBatchSize);
+	}
+
+	// leave the output at the end of the decoded data, like the stream decoder.
+	outStream.SeekPut(decodedOffsets[numFrames]);
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: checks whether the frames can be decoded in place back to front,
+//          which is the case if the decoded data of the frames before each
+//          batch is at least as large as their encoded data
+//-----------------------------------------------------------------------------
+static bool Pak_CanDecodeFramesInPlace(const std::vector<ZSTDSeekTableEntry_s>& seekTable)
+{
+	size_t encodedSize = 0;
+	size_t decodedSize = 0;
+
+	for (const ZSTDSeekTableEntry_s& entry : seekTable)
+	{
+		encodedSize += entry.compressedSize;
+		decodedSize += entry.decompressedSize;
+
+		if (decodedSize < encodedSize)
+			return false;
+	}
+
+	return true;
+}
+
+typedef std::unique_ptr<ZSTD_DDict, decltype(&ZSTD_freeDDict)> PakDecodeDictPtr_t;
+
+//-----------------------------------------------------------------------------
+// Purpose: loads and digests the dictionary, the digested dictionary is
+//          read-only and shared between all decoders
+//-----------------------------------------------------------------------------
+static PakDecodeDictPtr_t Pak_CreateDecodeDictionary(const char* const dictPath)
+{
+	PakDecodeDictPtr_t ddict(nullptr, &ZSTD_freeDDict);
+
+	if (!dictPath)
+		return ddict;
+
+	std::vector<uint8_t> dict;
+	Pak_LoadCompressDictionary(dictPath, dict);
+
+	ddict.reset(ZSTD_createDDict(dict.data(), dict.size()));
+
+	if (!ddict)
+		Error("Failed to create decompression dictionary from \"%s\".\n", dictPath);
+
+	return ddict;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: decodes a chunk of the zstd stream, and writes out the decoded data
+// Output : the decoder's last return value, 0 if the last frame got completed
+//-----------------------------------------------------------------------------
+static size_t Pak_DecodeStreamChunk(ZSTD_DCtx* const dctx, const void* const chunk, const size_t chunkSize,
+	BinaryIO& outStream, void* const buffOut, const size_t buffOutSize)
+{
+	ZSTD_inBuffer inputFrame = { chunk, chunkSize, 0 };
+	size_t lastRet = 0;
+
+	while (inputFrame.pos < inputFrame.size) {
+		ZSTD_outBuffer outputFrame = { buffOut, buffOutSize, 0 };
+		size_t const ret = ZSTD_decompressStream(dctx, &outputFrame, &inputFrame);
+
+		if (ZSTD_isError(ret))
+		{
+			Error("Failed to decompress stream to stream at %zd: [%s].\n",
+				outStream.TellPut(), ZSTD_getErrorName(ret));
+		}
+
+		outStream.Write(reinterpret_cast<uint8_t*>(buffOut), outputFrame.pos);
+		lastRet = ret;
+	}
+
+	return lastRet;
+}
+
+static bool Pak_StreamToStreamDecode(BinaryIO& inStream, BinaryIO& outStream, const size_t headerSize, const size_t decodedSize, const char* const dictPath)
+{
+	// only the data past the main header gets compressed.
+	const size_t encodedFrameSize = (static_cast<size_t>(inStream.GetSize()) - headerSize);
+
+	if (!encodedFrameSize)
+	{
+		Warning("%s: pak file contains no data to be decompressed.\n", __FUNCTION__);
+		return false;
+	}
+
+	const PakDecodeDictPtr_t ddict = Pak_CreateDecodeDictionary(dictPath);
+
+	// paks encoded as independent frames can be decoded in parallel.
+	std::vector<ZSTDSeekTableEntry_s> seekTable;
+
+	if (Pak_ReadSeekTable(inStream, headerSize, decodedSize, seekTable))
+	{
+		Log("Decoding %zu independent frames in parallel.\n", seekTable.size());
+		return Pak_StreamToStreamDecodeFrames(inStream, outStream, headerSize, seekTable, ddict.get(), false);
+	}
+
+	if (!Pak_InitDecoderContext(&s_zstdPakDecoder.dctx, ddict.get()))
+	{
+		return false;
+	}
 
 	const size_t buffInSize = ZSTD_DStreamInSize();
 	std::unique_ptr<uint8_t[]> buffInPtr(new uint8_t[buffInSize]);
@@ -620,48 +1408,147 @@ static bool Pak_StreamToStreamDecode(BinaryIO& inStream, BinaryIO& outStream, co
 		inStream.Read(reinterpret_cast<uint8_t*>(buffIn), numBytesToRead);
 		bytesLeft -= numBytesToRead;
 
-		ZSTD_inBuffer inputFrame = { buffIn, numBytesToRead, 0 };
+		lastRet = Pak_DecodeStreamChunk(&s_zstdPakDecoder.dctx, buffIn, numBytesToRead, outStream, buffOut, buffOutSize);
+	}
 
-		while (inputFrame.pos < inputFrame.size) {
-			ZSTD_outBuffer outputFrame = { buffOut, buffOutSize, 0 };
-			size_t const ret = ZSTD_decompressStream(&s_zstdPakDecoder.dctx, &outputFrame, &inputFrame);
+	if (lastRet != 0) {
 
-			if (ZSTD_isError(ret))
-			{
-				Error("Failed to decompress stream at %zd to stream at %zd: [%s].\n",
-					inStream.TellGet(), outStream.TellPut(), ZSTD_getErrorName(ret));
+		Error("Failed to decompress; reached EOF before end of stream! (%zu).\n", lastRet);
+		return false;
+	}
 
-				return false;
-			}
+	return true;
+}
 
-			outStream.Write(reinterpret_cast<uint8_t*>(buffOut), outputFrame.pos);
-			lastRet = ret;
-		}
+//-----------------------------------------------------------------------------
+// Purpose: decodes the pak into its own stream. seekable paks are decoded
+//          frame by frame back to front; other paks need the entire encoded
+//          data in memory, as the decoded data overtakes the encoded data
+//-----------------------------------------------------------------------------
+static bool Pak_StreamDecodeInPlace(BinaryIO& io, const size_t headerSize, const size_t decodedSize, const char* const dictPath)
+{
+	const size_t encodedFrameSize = (static_cast<size_t>(io.GetSize()) - headerSize);
+
+	if (!encodedFrameSize)
+	{
+		Warning("%s: pak file contains no data to be decompressed.\n", __FUNCTION__);
+		return false;
 	}
 
-	if (lastRet != 0) {
+	const PakDecodeDictPtr_t ddict = Pak_CreateDecodeDictionary(dictPath);
+	std::vector<ZSTDSeekTableEntry_s> seekTable;
 
-		Error("Failed to decompress; reached EOF before end of stream! (%zu).\n", lastRet);
-		return false;
+	if (Pak_ReadSeekTable(io, headerSize, decodedSize, seekTable) && Pak_CanDecodeFramesInPlace(seekTable))
+	{
+		Log("Decoding %zu independent frames in place.\n", seekTable.size());
+		return Pak_StreamToStreamDecodeFrames(io, io, headerSize, seekTable, ddict.get(), true);
 	}
 
+	Log("Decoding in place from %.1f MB of encoded data held in memory.\n", encodedFrameSize / (1024.0 * 1024.0));
+
+	std::unique_ptr<uint8_t[]> encodedData(new uint8_t[encodedFrameSize]);
+
+	io.SeekGet(headerSize);
+	io.Read(encodedData.get(), encodedFrameSize);
+
+	if (!Pak_InitDecoderContext(&s_zstdPakDecoder.dctx, ddict.get()))
+		return false;
+
+	const size_t buffOutSize = ZSTD_DStreamOutSize();
+	std::unique_ptr<uint8_t[]> buffOutPtr(new uint8_t[buffOutSize]);
+
+	io.SeekPut(headerSize);
+
+	const size_t lastRet = Pak_DecodeStreamChunk(&s_zstdPakDecoder.dctx, encodedData.get(), encodedFrameSize, io, buffOutPtr.get(), buffOutSize);
+
+	if (lastRet != 0)
+		Error("Failed to decompress; reached EOF before end of stream! (%zu).\n", lastRet);
+
 	return true;
 }
 
 //-----------------------------------------------------------------------------
-// Purpose: stream encode pak file to new stream and swap old stream with new
+// Purpose: converts the compress frame size option in megabytes to bytes, 0
+//          means the pak is encoded as a single frame
 //-----------------------------------------------------------------------------
-size_t Pak_EncodeStreamAndSwap(BinaryIO& io, const int compressLevel, const int workerCount, const uint16_t pakVersion, const char* const pakPath)
+size_t Pak_GetCompressFrameSize(const int frameSizeInMB)
 {
-	Log("*** encoding pak file \"%s\" with compress level %i and %i workers.\n", pakPath, compressLevel, workerCount);
+	const size_t frameSize = static_cast<size_t>(frameSizeInMB) * 1024 * 1024;
+
+	if (frameSizeInMB < 0 || frameSize > ZSTD_SEEKABLE_MAX_FRAME_SIZE)
+	{
+		Error("Compress frame size of %d MB is out of range [0, %zu].\n",
+			frameSizeInMB, static_cast<size_t>(ZSTD_SEEKABLE_MAX_FRAME_SIZE / (1024 * 1024)));
+	}
+
+	return frameSize;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: converts the compress job size option in megabytes to bytes, 0
+//          means the job size is derived from the compression parameters
+//-----------------------------------------------------------------------------
+size_t Pak_GetCompressJobSize(const int jobSizeInMB)
+{
+	const size_t jobSize = static_cast<size_t>(jobSizeInMB) * 1024 * 1024;
+
+	if (jobSizeInMB < 0 || jobSize > static_cast<size_t>(ZSTDMT_JOBSIZE_MAX))
+	{
+		Error("Compress job size of %d MB is out of range [0, %zu].\n",
+			jobSizeInMB, static_cast<size_t>(ZSTDMT_JOBSIZE_MAX) / (1024 * 1024));
+	}
+
+	return jobSize;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: checks the advanced encoder parameters, the window may not exceed
+//          what the runtime's decoder accepts by default
+//-----------------------------------------------------------------------------
+void Pak_ValidateEncodeSettings(const PakEncodeSettings_s& settings)
+{
+	if (settings.windowLog != 0 && (settings.windowLog < ZSTD_WINDOWLOG_MIN || settings.windowLog > ZSTD_WINDOWLOG_LIMIT_DEFAULT))
+	{
+		Error("Compress window log %d is out of range [%d, %d]; larger windows can't be decoded by the runtime.\n",
+			settings.windowLog, ZSTD_WINDOWLOG_MIN, ZSTD_WINDOWLOG_LIMIT_DEFAULT);
+	}
+
+	if (settings.strategy != 0 && (settings.strategy < ZSTD_fast || settings.strategy > ZSTD_btultra2))
+	{
+		Error("Compress strategy %d is out of range [%d, %d].\n",
+			settings.strategy, ZSTD_fast, ZSTD_btultra2);
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: stream encode pak file to new stream and swap old stream with new.
+//          if encoding in place, the pak is encoded into itself and truncated
+//          afterwards, which doesn't need any scratch space on disk but leaves
+//          the pak corrupt if encoding fails halfway
+//-----------------------------------------------------------------------------
+size_t Pak_EncodeStreamAndSwap(BinaryIO& io, const PakEncodeSettings_s& settings, const uint16_t pakVersion, const char* const pakPath, const bool inPlace)
+{
+	Log("*** encoding pak file \"%s\"%s with compress level %i and %i workers.\n", pakPath, inPlace ? " in place" : "", settings.compressLevel, settings.workerCount);
+
+	if (settings.windowLog || settings.strategy || settings.jobSize || settings.longDistance)
+	{
+		Log("*** advanced encoder parameters: window log %i, strategy %i, job size %zu, long distance matching %s.\n",
+			settings.windowLog, settings.strategy, settings.jobSize, settings.longDistance ? "on" : "off");
+	}
+
+	if (!settings.dictPath.empty())
+		Log("*** using compression dictionary \"%s\".\n", settings.dictPath.c_str());
+
 	const steady_clock::time_point start = high_resolution_clock::now();
 
 	BinaryIO outCompressed;
 	std::string outCompressedPath = pakPath;
 
-	outCompressedPath.append("_encoded");
+	// in place, the output is a second handle that trails the input.
+	if (!inPlace)
+		outCompressedPath.append("_encoded");
 
-	if (!outCompressed.Open(outCompressedPath, BinaryIO::Mode_e::Write))
+	if (!outCompressed.Open(outCompressedPath, inPlace ? BinaryIO::Mode_e::ReadWrite : BinaryIO::Mode_e::Write))
 	{
 		Warning("Failed to open output pak file \"%s\" for compression.\n", outCompressedPath.c_str());
 		return 0;
@@ -669,12 +1556,22 @@ size_t Pak_EncodeStreamAndSwap(BinaryIO& io, const int compressLevel, const int
 
 	const size_t decompressedSize = (size_t)io.GetSize();
 
-	if (!Pak_StreamToStreamEncode(io, outCompressed, Pak_GetHeaderSize(pakVersion), compressLevel, workerCount))
+	if (!Pak_StreamToStreamEncode(io, outCompressed, Pak_GetHeaderSize(pakVersion), settings, inPlace))
+	{
+		if (inPlace)
+			Error("Failed to encode pak file \"%s\" in place; pak file may be corrupt!\n", pakPath);
+
 		return 0;
+	}
 
 	const size_t compressedSize = outCompressed.TellPut();
 
-	if (!Util_ReplaceStream(io, outCompressed, pakPath, outCompressedPath.c_str()))
+	if (inPlace)
+	{
+		outCompressed.Close();
+		Util_TruncateStream(io, pakPath, compressedSize);
+	}
+	else if (!Util_ReplaceStream(io, outCompressed, pakPath, outCompressedPath.c_str()))
 		return 0;
 
 	const size_t reopenedPakSize = io.GetSize();
@@ -695,34 +1592,65 @@ size_t Pak_EncodeStreamAndSwap(BinaryIO& io, const int compressLevel, const int
 }
 
 //-----------------------------------------------------------------------------
-// Purpose: stream decode pak file to new stream and swap old stream with new
+// Purpose: reads the decompressed size from the pak header, the v7 header
+//          lacks the embedded starpak offset that precedes it in v8
+//-----------------------------------------------------------------------------
+size_t Pak_ReadHeaderDecompressedSize(BinaryIO& io, const uint16_t pakVersion)
+{
+	size_t offset = offsetof(PakHdr_t, decompressedSize);
+
+	if (pakVersion != 8)
+		offset -= sizeof(PakHdr_t::embeddedStarpakOffset);
+
+	io.SeekGet(offset);
+	return static_cast<size_t>(io.Read<uint64_t>());
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: stream decode pak file to new stream and swap old stream with new.
+//          if decoding in place, the pak is decoded into itself, see
+//          Pak_StreamDecodeInPlace()
 // TODO: support RTech and Oodle in stream wise manner as well
 //-----------------------------------------------------------------------------
-size_t Pak_DecodeStreamAndSwap(BinaryIO& io, const uint16_t pakVersion, const char* const pakPath)
+size_t Pak_DecodeStreamAndSwap(BinaryIO& io, const uint16_t pakVersion, const char* const pakPath, const char* const dictPath, const bool inPlace)
 {
-	Log("*** decoding pak file \"%s\".\n", pakPath);
+	Log("*** decoding pak file \"%s\"%s.\n", pakPath, inPlace ? " in place" : "");
 	const steady_clock::time_point start = high_resolution_clock::now();
 
-	BinaryIO outDecompressed;
-	std::string outDecompressedPath = pakPath;
+	const size_t compressedSize = (size_t)io.GetSize();
+	const size_t expectedSize = Pak_ReadHeaderDecompressedSize(io, pakVersion);
 
-	outDecompressedPath.append("_decoded");
+	size_t decompressedSize;
 
-	if (!outDecompressed.Open(outDecompressedPath, BinaryIO::Mode_e::Write))
+	if (inPlace)
 	{
-		Warning("Failed to open output pak file \"%s\" for decompression.\n", outDecompressedPath.c_str());
-		return 0;
+		if (!Pak_StreamDecodeInPlace(io, Pak_GetHeaderSize(pakVersion), expectedSize, dictPath))
+			return 0;
+
+		decompressedSize = io.TellPut();
+		Util_TruncateStream(io, pakPath, decompressedSize);
 	}
+	else
+	{
+		BinaryIO outDecompressed;
+		std::string outDecompressedPath = pakPath;
 
-	const size_t compressedSize = (size_t)io.GetSize();
+		outDecompressedPath.append("_decoded");
 
-	if (!Pak_StreamToStreamDecode(io, outDecompressed, Pak_GetHeaderSize(pakVersion)))
-		return 0;
+		if (!outDecompressed.Open(outDecompressedPath, BinaryIO::Mode_e::Write))
+		{
+			Warning("Failed to open output pak file \"%s\" for decompression.\n", outDecompressedPath.c_str());
+			return 0;
+		}
 
-	const size_t decompressedSize = outDecompressed.TellPut();
+		if (!Pak_StreamToStreamDecode(io, outDecompressed, Pak_GetHeaderSize(pakVersion), expectedSize, dictPath))
+			return 0;
 
-	if (!Util_ReplaceStream(io, outDecompressed, pakPath, outDecompressedPath.c_str()))
-		return 0;
+		decompressedSize = outDecompressed.TellPut();
+
+		if (!Util_ReplaceStream(io, outDecompressed, pakPath, outDecompressedPath.c_str()))
+			return 0;
+	}
 
 	const size_t reopenedPakSize = io.GetSize();
 
@@ -769,6 +1697,7 @@ void CPakFileBuilder::BuildFromMap(const js::Document& doc)
 		Error("Failed to open output pak file \"%s\".\n", m_pakFilePath.c_str());
 
 	Log("*** building pak file \"%s\".\n", m_pakFilePath.c_str());
+	const steady_clock::time_point start = high_resolution_clock::now();
 
 	// write a placeholder header so we can come back and complete it
 	// when we have all the info
@@ -781,9 +1710,34 @@ void CPakFileBuilder::BuildFromMap(const js::Document& doc)
 
 	if (JSON_GetIterator(doc, "files", JSONFieldType_e::kArray, filesIt))
 	{
-		for (const auto& file : filesIt->value.GetArray())
-			AddAsset(file);
+		const auto files = filesIt->value.GetArray();
+		BuildEvents_PakStarted(m_pakFilePath.c_str(), files.Size());
+
+		if (IsFlagSet(PF_KEEP_GOING))
+			AddAssetsCollectErrors(files);
+		else
+		{
+			for (const auto& file : files)
+				AddAsset(file);
+		}
+
+		if (!m_assetErrors.empty())
+		{
+			ReportAssetErrors(files.Size());
+
+			// don't leave a pak behind that is missing the failed assets.
+			out.Close();
+			fs::remove(m_pakFilePath);
+
+			Log("*** pak file \"%s\" was not written.\n", m_pakFilePath.c_str());
+			return;
+		}
 	}
+	else
+		BuildEvents_PakStarted(m_pakFilePath.c_str(), 0);
+
+	if (m_sharedLumpSavedBytes > 0)
+		Log("Deduplicated %zu bytes of data shared between assets (%zu unique lumps).\n", m_sharedLumpSavedBytes, m_sharedLumps.size());
 
 	{
 		// write string vectors for starpak paths and get the total length of each vector
@@ -840,8 +1794,23 @@ void CPakFileBuilder::BuildFromMap(const js::Document& doc)
 
 	if (compressLevel > 0 && decompressedFileSize > Pak_GetHeaderSize(m_Header.fileVersion))
 	{
-		const int workerCount = JSON_GetValueOrDefault(doc, "compressWorkers", 0);
-		compressedFileSize = Pak_EncodeStreamAndSwap(out, compressLevel, workerCount, GetVersion(), m_pakFilePath.c_str());
+		PakEncodeSettings_s encodeSettings;
+
+		encodeSettings.compressLevel = compressLevel;
+		encodeSettings.workerCount = JSON_GetValueOrDefault(doc, "compressWorkers", 0);
+		encodeSettings.frameSize = Pak_GetCompressFrameSize(JSON_GetValueOrDefault(doc, "compressFrameSize", 0));
+		encodeSettings.windowLog = JSON_GetValueOrDefault(doc, "compressWindowLog", 0);
+		encodeSettings.strategy = JSON_GetValueOrDefault(doc, "compressStrategy", 0);
+		encodeSettings.jobSize = Pak_GetCompressJobSize(JSON_GetValueOrDefault(doc, "compressJobSize", 0));
+		encodeSettings.longDistance = JSON_GetValueOrDefault(doc, "compressLongDistance", false);
+
+		// opt-in, the runtime must be given the same dictionary to load the pak.
+		if (JSON_GetValue(doc, "compressDictionary", encodeSettings.dictPath))
+			Utils::ResolvePath(encodeSettings.dictPath, m_buildSettings->GetBuildMapPath());
+
+		Pak_ValidateEncodeSettings(encodeSettings);
+
+		compressedFileSize = Pak_EncodeStreamAndSwap(out, encodeSettings, GetVersion(), m_pakFilePath.c_str(), false);
 
 		// set the header flags indicating this pak is compressed using zstandard.
 		m_Header.flags |= PAK_HEADER_FLAGS_ZSTD_ENCODED;
@@ -861,5 +1830,10 @@ void CPakFileBuilder::BuildFromMap(const js::Document& doc)
 	Log("*** built pak file \"%s\" with %zu assets, totaling %zd bytes.\n",
 		m_pakFilePath.c_str(), GetAssetCount(), totalPakSize);
 
+	const milliseconds duration = duration_cast<milliseconds>(high_resolution_clock::now() - start);
+
+	BuildEvents_PakFinished(m_pakFilePath.c_str(), GetAssetCount(), decompressedFileSize,
+		compressedFileSize == 0 ? decompressedFileSize : compressedFileSize, duration.count());
+
 	out.Close();
 }
@@ -23,6 +23,21 @@ enum class PakAssetScope_e
 	kAll,
 };
 
+// A lump of data that is shared between assets, see
+// CPakFileBuilder::CreateSharedPageLump().
+struct PakSharedLump_s
+{
+	PakPageLump_s lump;
+	int flags;
+};
+
+// An asset that failed to build, see PF_KEEP_GOING.
+struct PakAssetError_s
+{
+	std::string assetPath;
+	std::string message;
+};
+
 class CPakFileBuilder;
 typedef void(*PakAssetAddFunc_t)(CPakFileBuilder*, const PakGuid_t, const char*, const rapidjson::Value&);
 
@@ -60,6 +75,7 @@ public:
 
 	void AddJSONAsset(const PakAssetHandler_s& assetHandler, const char* const assetPath, const rapidjson::Value& file);
 	void AddAsset(const rapidjson::Value& file);
+	void AddAssetsCollectErrors(const rapidjson::Value::ConstArray& files);
 
 	void AddPointer(PakPageLump_s& pointerLump, const size_t pointerOffset, const PakPageLump_s& dataLump, const size_t dataOffset);
 	void AddPointer(PakPageLump_s& pointerLump, const size_t pointerOffset);
@@ -74,6 +90,7 @@ public:
 	inline bool IsFlagSet(const int flag) const { return m_buildSettings->IsFlagSet(flag); };
 
 	inline size_t GetAssetCount() const { return m_assets.size(); };
+	inline size_t GetAssetErrorCount() const { return m_assetErrors.size(); };
 	inline uint16_t GetNumPages() const { return m_pageBuilder.GetPageCount(); };
 
 	inline uint16_t GetVersion() const { return m_Header.fileVersion; }
@@ -123,6 +140,7 @@ public:
 	void GenerateAssetUses();
 
 	PakPageLump_s CreatePageLump(const size_t size, const int flags, const int alignment, void* const buf = nullptr);
+	PakPageLump_s CreateSharedPageLump(const void* const data, const size_t size, const int flags, const int alignment);
 	PakAsset_t* GetAssetByGuid(const PakGuid_t guid, size_t* const idx = nullptr, const bool silent = false);
 
 	FORCEINLINE PakAsset_t& BeginAsset(const PakGuid_t assetGuid, const char* const assetPath)
@@ -168,6 +186,13 @@ public:
 
 	void BuildFromMap(const js::Document& doc);
 
+private:
+	bool IsAssetScopeKept(const PakAssetScope_e scope) const;
+	PakGuid_t ValidateAssetEntry(const rapidjson::Value& file) const;
+
+	void RecordAssetError(const char* const assetPath, const char* const assetType, const std::string& message);
+	void ReportAssetErrors(const size_t numAssets) const;
+
 private:
 	const CBuildSettings* m_buildSettings;
 	CStreamFileBuilder* m_streamBuilder;
@@ -184,8 +209,20 @@ private:
 
 	CPakPageBuilder m_pageBuilder;
 
+	// Lumps created through CreateSharedPageLump(), keyed by the hash of
+	// their data; collisions are resolved by comparing the data itself.
+	std::unordered_multimap<uint64_t, PakSharedLump_s> m_sharedLumps;
+	size_t m_sharedLumpSavedBytes = 0;
+
+	// Size of the streaming data added by this pak, excluding data that was
+	// mapped to existing data in the stream files.
+	size_t m_streamDataSize = 0;
+
 	std::vector<std::string> m_mandatoryStreamFilePaths;
 	std::vector<std::string> m_optionalStreamFilePaths;
+
+	// Assets that failed to build, only collected with PF_KEEP_GOING.
+	std::vector<PakAssetError_s> m_assetErrors;
 };
 
 // if the asset already existed, the function will return true.
@@ -240,5 +277,35 @@ inline const char* Pak_EncodeAlgorithmToString(const uint16_t flags)
 	return "an unknown algorithm";
 }
 
-extern size_t Pak_EncodeStreamAndSwap(BinaryIO& io, const int compressLevel, const int workerCount, const uint16_t pakVersion, const char* const pakPath);
-extern size_t Pak_DecodeStreamAndSwap(BinaryIO& io, const uint16_t pakVersion, const char* const pakPath);
+struct PakEncodeSettings_s
+{
+	int compressLevel = 0;
+	int workerCount = 0;
+
+	// If non-zero, the data is split into independent frames of this size
+	// that are followed by a seek table, so they can be decoded in parallel.
+	size_t frameSize = 0;
+
+	// Advanced encoder parameters, 0 means the value is derived from the
+	// compression level. The window log can't exceed the default decoder
+	// limit, as the runtime wouldn't be able to decode the pak otherwise.
+	int windowLog = 0;
+	int strategy = 0; // ZSTD_strategy.
+	size_t jobSize = 0; // Size of each job when using multiple workers.
+
+	// Long distance matching finds matches across the whole window, useful
+	// for paks with similar assets that are far apart.
+	bool longDistance = false;
+
+	// Path to a zstd dictionary trained with -traindict, empty for none. The
+	// same dictionary is needed to decode the pak.
+	std::string dictPath;
+};
+
+extern void Pak_LoadCompressDictionary(const char* const dictPath, std::vector<uint8_t>& outDict);
+extern size_t Pak_GetCompressFrameSize(const int frameSizeInMB);
+extern size_t Pak_GetCompressJobSize(const int jobSizeInMB);
+extern void Pak_ValidateEncodeSettings(const PakEncodeSettings_s& settings);
+extern size_t Pak_EncodeStreamAndSwap(BinaryIO& io, const PakEncodeSettings_s& settings, const uint16_t pakVersion, const char* const pakPath, const bool inPlace);
+extern size_t Pak_ReadHeaderDecompressedSize(BinaryIO& io, const uint16_t pakVersion);
+extern size_t Pak_DecodeStreamAndSwap(BinaryIO& io, const uint16_t pakVersion, const char* const pakPath, const char* const dictPath, const bool inPlace);
@@ -188,6 +188,19 @@ PakPage_s& CPakPageBuilder::FindOrCreatePage(const int flags, const int align, c
 	return newPage;
 }
 
+//-----------------------------------------------------------------------------
+// Returns the total size of all page data created so far, including padding.
+//-----------------------------------------------------------------------------
+size_t CPakPageBuilder::GetDataSize() const
+{
+	size_t dataSize = 0;
+
+	for (const PakSlab_s& slab : m_slabs)
+		dataSize += slab.header.dataSize;
+
+	return dataSize;
+}
+
 //-----------------------------------------------------------------------------
 // Create a page lump, which is a piece of data that will be placed inside the
 // page with user requested alignment.
@@ -67,6 +67,8 @@ public:
 
 	const PakPageLump_s CreatePageLump(const int size, const int flags, const int align, void* const buf = nullptr);
 
+	size_t GetDataSize() const;
+
 	void PadSlabsAndPages();
 
 	void WriteSlabHeaders(BinaryIO& out) const;
@@ -296,15 +296,23 @@ StreamCacheFileHeader_s CStreamCache::ConstructHeader() const
 	return fileHeader;
 }
 
-StreamCacheFindParams_s CStreamCache::CreateParams(const uint8_t* const data, const int64_t size, const char* const streamFilePath)
+//-----------------------------------------------------------------------------
+// Purpose: creates the lookup params for given data. the data is hashed as if
+//          it was padded out with zeros to paddedSize, as that is how it will
+//          be stored in the stream file, but without the need to copy it into
+//          a buffer that is large enough to hold the padding.
+//-----------------------------------------------------------------------------
+StreamCacheFindParams_s CStreamCache::CreateParams(const uint8_t* const data, const int64_t size, const int64_t paddedSize, const char* const streamFilePath)
 {
+	assert(paddedSize >= size);
+
 	__m128i hash;
-	MurmurHash3_x64_128(data, static_cast<size_t>(size), MURMUR_SEED, &hash);
+	MurmurHash3_x64_128_ZeroPadded(data, static_cast<size_t>(size), static_cast<size_t>(paddedSize), MURMUR_SEED, &hash);
 
 	StreamCacheFindParams_s ret;
 
 	ret.hash = hash;
-	ret.size = size;
+	ret.size = paddedSize;
 	ret.streamFilePath = streamFilePath;
 
 	return ret;
@@ -372,6 +380,18 @@ void CStreamCache::Add(const StreamCacheFindParams_s& params, const int64_t offs
 	newDataEntry.hash = params.hash;
 }
 
+//-----------------------------------------------------------------------------
+// Purpose: drops all stream files and data entries that were added after the
+//          cache had the given number of them
+//-----------------------------------------------------------------------------
+void CStreamCache::Truncate(const size_t streamFileCount, const size_t dataEntryCount)
+{
+	assert(streamFileCount <= m_streamFiles.size() && dataEntryCount <= m_dataEntries.size());
+
+	m_streamFiles.resize(streamFileCount);
+	m_dataEntries.resize(dataEntryCount);
+}
+
 void CStreamCache::Save(BinaryIO& io)
 {
 	assert(io.IsWritable());
@@ -55,10 +55,11 @@ public:
 	int64_t AddStarpakPathToCache(const std::string& path, const bool optional);
 	StreamCacheFileHeader_s ConstructHeader() const;
 
-	static StreamCacheFindParams_s CreateParams(const uint8_t* const data, const int64_t size, const char* const streamFilePath);
+	static StreamCacheFindParams_s CreateParams(const uint8_t* const data, const int64_t size, const int64_t paddedSize, const char* const streamFilePath);
 
 	bool Find(const StreamCacheFindParams_s& params, StreamCacheFindResult_s& result, const bool optional);
 	void Add(const StreamCacheFindParams_s& params, const int64_t offset, const bool optional);
+	void Truncate(const size_t streamFileCount, const size_t dataEntryCount);
 
 	void Save(BinaryIO& io);
 
@@ -69,6 +70,9 @@ public:
 
 	inline bool HasStreamFileFilter() const { return !m_cacheFilter.empty(); }
 
+	inline size_t GetStreamFileCount() const { return m_streamFiles.size(); }
+	inline size_t GetDataEntryCount() const { return m_dataEntries.size(); }
+
 private:
 	std::vector<StreamCacheFileEntry_s> m_streamFiles;
 	std::vector<StreamCacheDataEntry_s> m_dataEntries;
@@ -184,7 +184,11 @@ bool CStreamFileBuilder::AddStreamingDataEntry(const int64_t size, const uint8_t
 	const bool isMandatory = set == STREAMING_SET_MANDATORY;
 	const std::string& newStarPak = isMandatory ? m_mandatoryStreamFileName : m_optionalStreamFileName;
 
-	StreamCacheFindParams_s params = m_streamCache.CreateParams(data, size, newStarPak.c_str());
+	// starpak data is aligned to 4096 bytes, the data doesn't have to be padded
+	// out by the caller as we hash and write the padding here.
+	const int64_t paddedSize = IALIGN(size, STARPAK_DATABLOCK_ALIGNMENT);
+
+	StreamCacheFindParams_s params = m_streamCache.CreateParams(data, size, paddedSize, newStarPak.c_str());
 	StreamCacheFindResult_s result;
 
 	if (m_streamCache.Find(params, result, !isMandatory))
@@ -201,17 +205,30 @@ bool CStreamFileBuilder::AddStreamingDataEntry(const int64_t size, const uint8_t
 	if (!out.IsWritable())
 		Error("Attempted to write %s streaming asset without a stream file handle.\n", Pak_StreamSetToName(set));
 
-	const int64_t dataOffset = out.GetSize();
-	assert(dataOffset >= STARPAK_DATABLOCK_ALIGNMENT);
+	std::vector<uint8_t>* const heldData = m_holdingWrites
+		? (isMandatory ? &m_heldWrites.mandatoryData : &m_heldWrites.optionalData)
+		: nullptr;
 
-	out.Write(data, size);
-	const int64_t paddedSize = IALIGN(size, STARPAK_DATABLOCK_ALIGNMENT);
+	// held data is written right after the data that is already in the file.
+	const int64_t dataOffset = out.GetSize() + (heldData ? heldData->size() : 0);
+	assert(dataOffset >= STARPAK_DATABLOCK_ALIGNMENT);
 
-	// starpak data is aligned to 4096 bytes, pad the remainder out for the next asset.
-	if (paddedSize > size)
+	if (heldData)
 	{
-		const size_t paddingRemainder = paddedSize - size;
-		out.Pad(paddingRemainder);
+		// the padding is zeroed out by the resize.
+		heldData->insert(heldData->end(), data, data + size);
+		heldData->resize(heldData->size() + (paddedSize - size));
+	}
+	else
+	{
+		out.Write(data, size);
+
+		// pad the remainder out for the next asset.
+		if (paddedSize > size)
+		{
+			const size_t paddingRemainder = paddedSize - size;
+			out.Pad(paddingRemainder);
+		}
 	}
 
 	std::vector<PakStreamSetAssetEntry_s>& dataBlockDescs = isMandatory ? m_mandatoryStreamingDataBlocks : m_optionalStreamingDataBlocks;
@@ -226,3 +243,58 @@ bool CStreamFileBuilder::AddStreamingDataEntry(const int64_t size, const uint8_t
 	m_streamCache.Add(params, dataOffset, !isMandatory);
 	return true;
 }
+
+//-----------------------------------------------------------------------------
+// purpose: holds back all streaming data added from here on until it is
+//          committed or discarded, so the data of an asset that fails to
+//          build never ends up in the stream files or the cache
+//-----------------------------------------------------------------------------
+void CStreamFileBuilder::HoldWrites()
+{
+	assert(!m_holdingWrites);
+
+	m_heldWrites.mandatoryBlockCount = m_mandatoryStreamingDataBlocks.size();
+	m_heldWrites.optionalBlockCount = m_optionalStreamingDataBlocks.size();
+
+	m_heldWrites.cacheStreamFileCount = m_streamCache.GetStreamFileCount();
+	m_heldWrites.cacheDataEntryCount = m_streamCache.GetDataEntryCount();
+
+	m_holdingWrites = true;
+}
+
+//-----------------------------------------------------------------------------
+// purpose: writes out the held streaming data
+//-----------------------------------------------------------------------------
+void CStreamFileBuilder::CommitHeldWrites()
+{
+	assert(m_holdingWrites);
+
+	if (!m_heldWrites.mandatoryData.empty())
+		m_mandatoryStreamFile.Write(m_heldWrites.mandatoryData.data(), m_heldWrites.mandatoryData.size());
+
+	if (!m_heldWrites.optionalData.empty())
+		m_optionalStreamFile.Write(m_heldWrites.optionalData.data(), m_heldWrites.optionalData.size());
+
+	m_heldWrites.mandatoryData.clear();
+	m_heldWrites.optionalData.clear();
+
+	m_holdingWrites = false;
+}
+
+//-----------------------------------------------------------------------------
+// purpose: drops the held streaming data, along with its data block entries
+//          and the cache entries that were added for it
+//-----------------------------------------------------------------------------
+void CStreamFileBuilder::DiscardHeldWrites()
+{
+	assert(m_holdingWrites);
+
+	m_heldWrites.mandatoryData.clear();
+	m_heldWrites.optionalData.clear();
+
+	m_mandatoryStreamingDataBlocks.resize(m_heldWrites.mandatoryBlockCount);
+	m_optionalStreamingDataBlocks.resize(m_heldWrites.optionalBlockCount);
+
+	m_streamCache.Truncate(m_heldWrites.cacheStreamFileCount, m_heldWrites.cacheDataEntryCount);
+	m_holdingWrites = false;
+}
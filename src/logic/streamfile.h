@@ -11,6 +11,21 @@ struct StreamAddEntryResults_s
 	int64_t pathIndex : 12;
 };
 
+// Streaming data that is held back while an asset is being built, see
+// CStreamFileBuilder::HoldWrites().
+struct StreamHeldWrites_s
+{
+	std::vector<uint8_t> mandatoryData;
+	std::vector<uint8_t> optionalData;
+
+	// State from before the writes were held, to restore on discard.
+	size_t mandatoryBlockCount;
+	size_t optionalBlockCount;
+
+	size_t cacheStreamFileCount;
+	size_t cacheDataEntryCount;
+};
+
 class CStreamFileBuilder
 {
 public:
@@ -24,6 +39,10 @@ public:
 
 	bool AddStreamingDataEntry(const int64_t size, const uint8_t* const data, const PakStreamSet_e set, StreamAddEntryResults_s& results);
 
+	void HoldWrites();
+	void CommitHeldWrites();
+	void DiscardHeldWrites();
+
 	inline size_t GetMandatoryStreamingAssetCount() const { return m_mandatoryStreamingDataBlocks.size(); };
 	inline size_t GetOptionalStreamingAssetCount() const { return m_optionalStreamingDataBlocks.size(); };
 
@@ -41,4 +60,7 @@ private:
 
 	std::vector<PakStreamSetAssetEntry_s> m_mandatoryStreamingDataBlocks;
 	std::vector<PakStreamSetAssetEntry_s> m_optionalStreamingDataBlocks;
+
+	bool m_holdingWrites = false;
+	StreamHeldWrites_s m_heldWrites;
 };
@@ -7,6 +7,9 @@
 #include <iostream>
 #include <unordered_map>
 #include <set>
+#include <deque>
+#include <thread>
+#include <atomic>
 #include <unordered_set>
 //#include <sysinfoapi.h>
 #include <vector>
@@ -22,7 +25,6 @@
 namespace rapidjson { typedef ::std::size_t SizeType; }
 
 #include <rapidjson/document.h>
-#include <rapidjson/istreamwrapper.h>
 #include <rapidjson/prettywriter.h>
 #include <rapidjson/error/en.h>
 
@@ -35,6 +37,8 @@ namespace rapidjson { typedef ::std::size_t SizeType; }
 #include "logic/rtech.h"
 
 #include "utils/binaryio.h"
+#include "utils/mappedfile.h"
+#include "utils/csvreader.h"
 #include "utils/utils.h"
 #include "utils/strutils.h"
 #include "utils/jsonutils.h"
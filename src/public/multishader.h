@@ -436,6 +436,72 @@ public:
 		}
 	}
 
+	// Parses a MSW file that has already been loaded or mapped into memory.
+	// Unlike ReadFile, the shader entries reference the bytecode in place, so
+	// the data must outlive the cache. Returns false if the file is truncated.
+	bool ReadFromMemory(const char* const data, const size_t dataSize, ShaderCache_t* const outCache)
+	{
+		assert(outCache);
+		MultiShaderWrapper_Header_t fileHeader = {};
+
+		if (!ReadMemory(data, dataSize, 0, &fileHeader, sizeof(fileHeader)))
+			return false;
+
+		if (fileHeader.magic != MSW_FILE_MAGIC)
+			Error("Attempted to load an invalid MSW file (expected magic %x, got %x).\n", MSW_FILE_MAGIC, fileHeader.magic);
+
+		if (fileHeader.version != MSW_FILE_VER)
+			Error("Attempted to load an unsupported MSW file (expected version %u, got %u).\n", MSW_FILE_VER, fileHeader.version);
+
+		outCache->type = fileHeader.fileType;
+
+		if (fileHeader.fileType == MultiShaderWrapperFileType_e::SHADER)
+		{
+			outCache->shader = new Shader_t;
+			outCache->deleteShader = true;
+
+			return ReadShaderFromMemory(data, dataSize, sizeof(fileHeader), outCache->shader);
+		}
+		else if (fileHeader.fileType == MultiShaderWrapperFileType_e::SHADERSET)
+		{
+			MultiShaderWrapper_ShaderSet_t shds;
+
+			if (!ReadMemory(data, dataSize, sizeof(fileHeader), &shds, sizeof(shds)))
+				return false;
+
+			outCache->shaderSet.pixelShaderGuid = shds.pixelShaderGuid;
+			outCache->shaderSet.vertexShaderGuid = shds.vertexShaderGuid;
+
+			outCache->shaderSet.numPixelShaderTextures = shds.numPixelShaderTextures;
+			outCache->shaderSet.numVertexShaderTextures = shds.numVertexShaderTextures;
+
+			outCache->shaderSet.numSamplers = shds.numSamplers;
+
+			outCache->shaderSet.firstResourceBindPoint = shds.firstResourceBindPoint;
+			outCache->shaderSet.numResources = shds.numResources;
+
+			outCache->shaderSet.deleteShaders = true;
+
+			if (shds.pixelShaderOffset)
+			{
+				outCache->shaderSet.pixelShader = new Shader_t;
+
+				if (!ReadShaderFromMemory(data, dataSize, shds.pixelShaderOffset, outCache->shaderSet.pixelShader))
+					return false;
+			}
+
+			if (shds.vertexShaderOffset)
+			{
+				outCache->shaderSet.vertexShader = new Shader_t;
+
+				if (!ReadShaderFromMemory(data, dataSize, shds.vertexShaderOffset, outCache->shaderSet.vertexShader))
+					return false;
+			}
+		}
+
+		return true;
+	}
+
 	__forceinline bool WriteFile(const char* filePath)
 	{
 		if (!writtenAnything)
@@ -466,6 +532,78 @@ public:
 	}
 
 private:
+	static inline bool ReadMemory(const char* const data, const size_t dataSize, const size_t offset, void* const out, const size_t outSize)
+	{
+		if (offset > dataSize || outSize > dataSize - offset)
+			return false;
+
+		memcpy(out, &data[offset], outSize);
+		return true;
+	}
+
+	bool ReadShaderFromMemory(const char* const data, const size_t dataSize, const size_t shaderOffset, Shader_t* const shader)
+	{
+		MultiShaderWrapper_Shader_t shdr = {};
+
+		if (!ReadMemory(data, dataSize, shaderOffset, &shdr, sizeof(shdr)))
+			return false;
+
+		const size_t descStartOffset = shaderOffset + sizeof(shdr);
+		shader->entries.reserve(shdr.numShaderDescriptors);
+
+		for (size_t i = 0; i < shdr.numShaderDescriptors; ++i)
+		{
+			const size_t thisDescOffset = descStartOffset + (i * sizeof(MultiShaderWrapper_ShaderDesc_t));
+			MultiShaderWrapper_ShaderDesc_t desc;
+
+			if (!ReadMemory(data, dataSize, thisDescOffset, &desc, sizeof(desc)))
+				return false;
+
+			ShaderEntry_t& entry = shader->entries.emplace_back();
+
+			if (desc.u_ref.bufferIndex == UINT32_MAX && desc.u_ref._reserved == UINT32_MAX)
+			{
+				// null shader entry
+				entry.refIndex = UINT16_MAX;
+			}
+			else if (desc.u_ref._reserved == 0 && desc.u_ref.bufferIndex != UINT32_MAX)
+			{
+				entry.refIndex = static_cast<unsigned short>(desc.u_ref.bufferIndex);
+			}
+			else
+			{
+				// regular shader - reference the buffer directly
+				const size_t bufferOffset = thisDescOffset + desc.u_standard.bufferOffset;
+
+				if (bufferOffset > dataSize || desc.u_standard.bufferLength > dataSize - bufferOffset)
+					return false;
+
+				entry.buffer = &data[bufferOffset];
+				entry.size = desc.u_standard.bufferLength;
+				entry.refIndex = UINT16_MAX;
+				entry.deleteBuffer = false;
+			}
+
+			entry.flags[0] = desc.inputFlags[0];
+			entry.flags[1] = desc.inputFlags[1];
+		}
+
+		// shader type isn't saved, so it has to be found from the shader bytecode separately
+		shader->shaderType = MultiShaderWrapperShaderType_e::INVALID;
+		memcpy(shader->features, &shdr, sizeof(shader->features));
+
+		if (shdr.nameLength > 0)
+		{
+			// The name comes last in the shader block.
+			if (shdr.nameOffset > dataSize || shdr.nameLength > dataSize - shdr.nameOffset)
+				return false;
+
+			shader->name.assign(&data[shdr.nameOffset], shdr.nameLength - 1);
+		}
+
+		return true;
+	}
+
 	inline void WriteShaderSet(FILE* f)
 	{
 		MultiShaderWrapper_ShaderSet_t shaderSet =
@@ -610,13 +748,21 @@ static inline const char* MSW_TypeToString(const MultiShaderWrapperFileType_e ex
 	return "unknown";
 }
 
-static inline bool MSW_ParseFile(const fs::path& inputPath, CMultiShaderWrapperIO::ShaderCache_t& shaderCache, const MultiShaderWrapperFileType_e expectType)
+// The shader entries reference the bytecode in the mapped file, which must stay
+// open for as long as the shader cache is used.
+static inline bool MSW_ParseFile(const fs::path& inputPath, CMappedFile& mappedFile, CMultiShaderWrapperIO::ShaderCache_t& shaderCache, const MultiShaderWrapperFileType_e expectType)
 {
+	if (!mappedFile.Open(inputPath.string()))
+	{
+		Error("Failed to load MSW file \"%s\".\n", inputPath.string().c_str());
+		return false;
+	}
+
 	CMultiShaderWrapperIO io;
 
-	if (!io.ReadFile(inputPath.string().c_str(), &shaderCache))
+	if (!io.ReadFromMemory(mappedFile.GetData<char>(), mappedFile.GetSize(), &shaderCache))
 	{
-		Error("Failed to load MSW file \"%s\".\n", inputPath.string().c_str());
+		Error("MSW file \"%s\" is truncated or corrupt.\n", inputPath.string().c_str());
 		return false;
 	}
 
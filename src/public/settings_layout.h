@@ -81,6 +81,10 @@ struct SettingsLayoutParseResult_s
 	std::vector<uint32_t> bucketMap;
 	std::vector<SettingsFieldType_e> typeMap;
 
+	// Field name to the indices of all fields using that name, in order of
+	// occurrence; used to map settings asset fields to their layout fields.
+	std::unordered_map<std::string, std::vector<uint32_t>> fieldNameMap;
+
 	size_t subHeadersBufBase;
 	size_t curSubHeaderBufIndex;
 
@@ -123,6 +127,9 @@ extern uint32_t SettingsLayout_GetFieldSizeForType(const SettingsFieldType_e typ
 extern uint32_t SettingsLayout_GetFieldAlignmentForType(const SettingsFieldType_e type);
 extern SettingsFieldType_e SettingsLayout_GetFieldTypeForString(const char* const typeName);
 
+// Parses the layout on first use, subsequent calls return the cached layout.
+extern const SettingsLayoutAsset_s& SettingsLayout_GetParsedLayout(CPakFileBuilder* const pak, const char* const assetPath);
+
 struct SettingsLayoutFindByOffsetResult_s
 {
 	SettingsLayoutFindByOffsetResult_s()
@@ -35,7 +35,7 @@ struct studiohdr_t
 
 	int flags;
 
-	inline bool IsStaticProp() { return flags & 0x10; };
+	inline bool IsStaticProp() const { return flags & 0x10; };
 
 	int numbones; // bones
 	int boneindex;
@@ -409,4 +409,56 @@ struct VertexGroupHeader_t
 
 	int unused[16];
 };
+
+// strip flags
+#define VG_STRIP_IS_TRILIST 0x01
+#define VG_STRIP_IS_TRISTRIP 0x02
+
+// size: 0x48 (72 bytes)
+struct VertexGroupMesh_t
+{
+	__int64 flags;                 // mesh flags
+
+	unsigned int vertOffset;       // start offset for this mesh's vertices, in bytes
+	unsigned int vertCacheSize;    // size of a single vertex in bytes (vertex stride)
+	unsigned int vertCount;        // number of vertices
+
+	int unk1;
+
+	int extraBoneWeightOffset;     // start offset for this mesh's "extended weights"
+	int extraBoneWeightSize;       // size or count of extended weights
+
+	int indexOffset;               // index into the index buffer
+	int indexCount;                // number of indices
+
+	int legacyWeightOffset;        // index into the legacy weight buffer
+	int legacyWeightCount;         // number of legacy weights used by this mesh
+
+	int stripOffset;               // index into the strip buffer
+	int stripCount;                // number of strips
+
+	int unk[4];
+};
+static_assert(sizeof(VertexGroupMesh_t) == 0x48);
+
+// size: 0x23 (35 bytes)
+struct VertexGroupStrip_t
+{
+	int numIndices;                // indices in this strip
+	int indexOffset;               // relative to the mesh's first index
+
+	int numVerts;                  // vertices used by this strip
+	int vertOffset;                // relative to the mesh's first vertex
+
+	short numBones;
+
+	unsigned char flags;           // see VG_STRIP_* flags
+
+	int numBoneStateChanges;
+	int boneStateChangeOffset;
+
+	int numTopologyIndices;
+	int topologyOffset;
+};
+static_assert(sizeof(VertexGroupStrip_t) == 0x23);
 #pragma pack(pop)
\ No newline at end of file
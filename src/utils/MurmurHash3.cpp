@@ -8,6 +8,8 @@
 // non-native version will be less than optimal.
 
 #include "MurmurHash3.h"
+#include <string.h>
+#include <assert.h>
 
 //-----------------------------------------------------------------------------
 // Platform-specific functions and macros
@@ -169,3 +171,121 @@ void MurmurHash3_x64_128(const void* key, const size_t len,
     ((uint64_t*)out)[0] = h1;
     ((uint64_t*)out)[1] = h2;
 }
+
+//-----------------------------------------------------------------------------
+// Same as MurmurHash3_x64_128, but hashes the key as if it was followed by
+// (paddedLen - len) zero bytes. This allows hashing data that needs to be
+// padded out to a boundary without having to copy it into a larger buffer.
+
+FORCE_INLINE void mixblock64(uint64_t& h1, uint64_t& h2, uint64_t k1, uint64_t k2)
+{
+    const uint64_t c1 = BIG_CONSTANT(0x87c37b91114253d5);
+    const uint64_t c2 = BIG_CONSTANT(0x4cf5ad432745937f);
+
+    k1 *= c1; k1 = ROTL64(k1, 31); k1 *= c2; h1 ^= k1;
+
+    h1 = ROTL64(h1, 27); h1 += h2; h1 = h1 * 5 + 0x52dce729;
+
+    k2 *= c2; k2 = ROTL64(k2, 33); k2 *= c1; h2 ^= k2;
+
+    h2 = ROTL64(h2, 31); h2 += h1; h2 = h2 * 5 + 0x38495ab5;
+}
+
+void MurmurHash3_x64_128_ZeroPadded(const void* key, const size_t len,
+    const size_t paddedLen, const uint32_t seed, void* out)
+{
+    assert(paddedLen >= len);
+
+    const uint8_t* data = (const uint8_t*)key;
+    const size_t nblocks = len / 16;
+    const size_t npaddedblocks = paddedLen / 16;
+
+    uint64_t h1 = seed;
+    uint64_t h2 = seed;
+
+    const uint64_t c1 = BIG_CONSTANT(0x87c37b91114253d5);
+    const uint64_t c2 = BIG_CONSTANT(0x4cf5ad432745937f);
+
+    //----------
+    // body, straight from the key
+
+    const uint64_t* blocks = (const uint64_t*)(data);
+
+    for (size_t i = 0; i < nblocks; i++)
+        mixblock64(h1, h2, getblock64(blocks, i * 2 + 0), getblock64(blocks, i * 2 + 1));
+
+    //----------
+    // the last partial block of the key, followed by zeros
+
+    uint64_t last[2] = { 0, 0 };
+    const size_t remainder = len & 15;
+
+    if (remainder)
+        memcpy(last, data + nblocks * 16ull, remainder);
+
+    size_t i = nblocks;
+
+    if (i < npaddedblocks)
+    {
+        mixblock64(h1, h2, last[0], last[1]);
+        i++;
+
+        // the partial block has been consumed, the tail is all zeros now.
+        last[0] = 0;
+        last[1] = 0;
+    }
+
+    //----------
+    // body, zero padding
+
+    for (; i < npaddedblocks; i++)
+        mixblock64(h1, h2, 0, 0);
+
+    //----------
+    // tail
+
+    const size_t taillen = paddedLen & 15;
+    const uint8_t* tail = (const uint8_t*)last;
+
+    uint64_t k1 = 0;
+    uint64_t k2 = 0;
+
+    switch (taillen)
+    {
+    case 15: k2 ^= ((uint64_t)tail[14]) << 48;
+    case 14: k2 ^= ((uint64_t)tail[13]) << 40;
+    case 13: k2 ^= ((uint64_t)tail[12]) << 32;
+    case 12: k2 ^= ((uint64_t)tail[11]) << 24;
+    case 11: k2 ^= ((uint64_t)tail[10]) << 16;
+    case 10: k2 ^= ((uint64_t)tail[9]) << 8;
+    case  9: k2 ^= ((uint64_t)tail[8]) << 0;
+        k2 *= c2; k2 = ROTL64(k2, 33); k2 *= c1; h2 ^= k2;
+
+    case  8: k1 ^= ((uint64_t)tail[7]) << 56;
+    case  7: k1 ^= ((uint64_t)tail[6]) << 48;
+    case  6: k1 ^= ((uint64_t)tail[5]) << 40;
+    case  5: k1 ^= ((uint64_t)tail[4]) << 32;
+    case  4: k1 ^= ((uint64_t)tail[3]) << 24;
+    case  3: k1 ^= ((uint64_t)tail[2]) << 16;
+    case  2: k1 ^= ((uint64_t)tail[1]) << 8;
+    case  1: k1 ^= ((uint64_t)tail[0]) << 0;
+        k1 *= c1; k1 = ROTL64(k1, 31); k1 *= c2; h1 ^= k1;
+    };
+
+    //----------
+    // finalization
+
+    h1 ^= paddedLen; h2 ^= paddedLen;
+
+    h1 += h2;
+    h2 += h1;
+
+    h1 = fmix64(h1);
+    h2 = fmix64(h2);
+
+    h1 += h2;
+    h2 += h1;
+
+    ((uint64_t*)out)[0] = h1;
+    ((uint64_t*)out)[1] = h2;
+}
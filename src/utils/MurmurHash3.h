@@ -27,6 +27,7 @@ typedef unsigned __int64 uint64_t;
 //-----------------------------------------------------------------------------
 
 void MurmurHash3_x64_128(const void* key, const size_t len, const uint32_t seed, void* out);
+void MurmurHash3_x64_128_ZeroPadded(const void* key, const size_t len, const size_t paddedLen, const uint32_t seed, void* out);
 
 //-----------------------------------------------------------------------------
 
@@ -7,6 +7,9 @@
 //-----------------------------------------------------------------------------
 BinaryIO::BinaryIO()
 {
+	m_writeBufUsed = 0;
+	m_writeBufCapacity = 0;
+
 	Reset();
 }
 
@@ -52,6 +55,7 @@ bool BinaryIO::Open(const char* const filePath, const Mode_e mode)
 
 	if (m_stream.is_open())
 	{
+		SyncWriteBuffer();
 		m_stream.close();
 	}
 
@@ -92,6 +96,7 @@ void BinaryIO::Reset()
 //-----------------------------------------------------------------------------
 void BinaryIO::Close()
 {
+	SyncWriteBuffer();
 	m_stream.close();
 	Reset();
 }
@@ -101,8 +106,11 @@ void BinaryIO::Close()
 //-----------------------------------------------------------------------------
 void BinaryIO::Flush()
 {
-	if (IsWritable())
-		m_stream.flush();
+	if (!IsWritable())
+		return;
+
+	SyncWriteBuffer();
+	m_stream.flush();
 }
 
 //-----------------------------------------------------------------------------
@@ -112,11 +120,15 @@ void BinaryIO::Flush()
 std::streamoff BinaryIO::TellGet()
 {
 	assert(IsReadMode());
+
+	SyncWriteBuffer();
 	return m_stream.tellg();
 }
 std::streamoff BinaryIO::TellPut()
 {
 	assert(IsWriteMode());
+
+	SyncWriteBuffer();
 	return m_stream.tellp();
 }
 
@@ -128,6 +140,8 @@ std::streamoff BinaryIO::TellPut()
 void BinaryIO::SeekGet(const std::streamoff offset, const std::ios_base::seekdir way)
 {
 	assert(IsReadMode());
+
+	SyncWriteBuffer();
 	m_stream.seekg(offset, way);
 }
 //-----------------------------------------------------------------------------
@@ -138,6 +152,8 @@ void BinaryIO::SeekPut(const std::streamoff offset, const std::ios_base::seekdir
 {
 	assert(IsWriteMode());
 
+	SyncWriteBuffer();
+
 	CalcSkipDelta(offset, way);
 	m_stream.seekp(offset, way);
 }
@@ -272,9 +288,7 @@ bool BinaryIO::WriteString(const std::string& input, const bool nullterminate)
 	const char* const text = input.c_str();
 	const size_t len = input.length() + nullterminate;
 
-	m_stream.write(text, len);
-	CalcAddDelta(len);
-
+	WriteBuffered(text, len);
 	return true;
 }
 
@@ -284,12 +298,35 @@ static constexpr size_t PAD_BUF_SIZE = 4096;
 const static char s_padBuf[PAD_BUF_SIZE];
 
 //-----------------------------------------------------------------------------
-// Purpose: pads the out stream up to count bytes
+// Purpose: pads the out stream up to count bytes with zeros
 // Input  : count - 
 //-----------------------------------------------------------------------------
 void BinaryIO::Pad(const size_t count)
 {
 	assert(count > 0);
+
+	if (!IsWritable())
+		return;
+
+	// if the padding extends the file past its end, we only have to write the
+	// last byte, the file system fills the gap with zeros for us. small pads
+	// are cheaper to write into the write buffer than to flush it and seek.
+	// m_skip is also 0 at the start of an existing file opened for writing,
+	// so the actual position must be checked against the end.
+	if (m_skip == 0 && count >= BINARYIO_SEEK_PAD_MIN_SIZE)
+	{
+		SyncWriteBuffer();
+
+		if (m_stream.tellp() >= m_size)
+		{
+			m_stream.seekp(static_cast<std::streamoff>(count - 1), std::ios::cur);
+			CalcAddDelta(count - 1);
+
+			Write(s_padBuf, 1);
+			return;
+		}
+	}
+
 	size_t remainder = count;
 
 	while (remainder)
@@ -301,6 +338,41 @@ void BinaryIO::Pad(const size_t count)
 	}
 }
 
+//-----------------------------------------------------------------------------
+// Purpose: writes data that didn't fit in the write buffer; large writes go
+//          straight to the stream, small writes start a new buffer
+// Input  : *data - 
+//			count - 
+//-----------------------------------------------------------------------------
+void BinaryIO::WriteUnbuffered(const char* const data, const size_t count)
+{
+	SyncWriteBuffer();
+
+	if (count >= BINARYIO_WRITE_BUFFER_SIZE / 2)
+	{
+		m_stream.write(data, count);
+		return;
+	}
+
+	if (!m_writeBuf)
+	{
+		m_writeBuf.reset(new char[BINARYIO_WRITE_BUFFER_SIZE]);
+		m_writeBufCapacity = BINARYIO_WRITE_BUFFER_SIZE;
+	}
+
+	memcpy(m_writeBuf.get(), data, count);
+	m_writeBufUsed = count;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: passes all pending writes to the stream
+//-----------------------------------------------------------------------------
+void BinaryIO::FlushWriteBuffer()
+{
+	m_stream.write(m_writeBuf.get(), m_writeBufUsed);
+	m_writeBufUsed = 0;
+}
+
 //-----------------------------------------------------------------------------
 // Purpose: makes sure that the size gets incremented if we exceeded the end of
 //          the stream with the delta amount
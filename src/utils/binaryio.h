@@ -1,5 +1,16 @@
 #pragma once
 
+// Size of the user-space write buffer. Writes are accumulated in this buffer
+// and passed to the stream in one call when it is full, when seeking, reading
+// or when the stream gets flushed or closed, so small writes such as header
+// fields don't each go through the stream's sentry and locale machinery.
+// Writes that are at least half this size bypass the buffer.
+#define BINARYIO_WRITE_BUFFER_SIZE (1024 * 1024)
+
+// Padding of at least this size at the end of the file is done by seeking past
+// the end instead of writing out zeros, see BinaryIO::Pad().
+#define BINARYIO_SEEK_PAD_MIN_SIZE (64 * 1024)
+
 class BinaryIO
 {
 public:
@@ -46,8 +57,11 @@ public:
 	template<typename T>
 	inline void Read(T& value)
 	{
-		if (IsReadable())
-			m_stream.read(reinterpret_cast<char*>(&value), sizeof(value));
+		if (!IsReadable())
+			return;
+
+		SyncWriteBuffer();
+		m_stream.read(reinterpret_cast<char*>(&value), sizeof(value));
 	}
 
 	//-----------------------------------------------------------------------------
@@ -56,14 +70,20 @@ public:
 	template<typename T>
 	inline void Read(T* const value, const size_t size)
 	{
-		if (IsReadable())
-			m_stream.read(reinterpret_cast<char*>(value), size);
+		if (!IsReadable())
+			return;
+
+		SyncWriteBuffer();
+		m_stream.read(reinterpret_cast<char*>(value), size);
 	}
 	template<typename T>
 	inline void Read(T& value, const size_t size)
 	{
-		if (IsReadable())
-			m_stream.read(reinterpret_cast<char*>(&value), size);
+		if (!IsReadable())
+			return;
+
+		SyncWriteBuffer();
+		m_stream.read(reinterpret_cast<char*>(&value), size);
 	}
 
 	//-----------------------------------------------------------------------------
@@ -76,6 +96,7 @@ public:
 		if (!IsReadable())
 			return value;
 
+		SyncWriteBuffer();
 		m_stream.read(reinterpret_cast<char*>(&value), sizeof(value));
 		return value;
 	}
@@ -91,10 +112,7 @@ public:
 		if (!IsWritable())
 			return;
 
-		const size_t count = sizeof(value);
-
-		m_stream.write(reinterpret_cast<const char*>(&value), count);
-		CalcAddDelta(count);
+		WriteBuffered(reinterpret_cast<const char*>(&value), sizeof(value));
 	}
 
 	//-----------------------------------------------------------------------------
@@ -106,18 +124,48 @@ public:
 		if (!IsWritable())
 			return;
 
-		m_stream.write(reinterpret_cast<const char*>(value), size);
-		CalcAddDelta(size);
+		WriteBuffered(reinterpret_cast<const char*>(value), size);
 	}
 	bool WriteString(const std::string& svInput, const bool nullterminate);
 	void Pad(const size_t count);
 
 protected:
+	//-----------------------------------------------------------------------------
+	// Purpose: appends the data to the write buffer, or passes it to the stream
+	//          if it doesn't fit
+	//-----------------------------------------------------------------------------
+	inline void WriteBuffered(const char* const data, const size_t count)
+	{
+		if (count <= m_writeBufCapacity - m_writeBufUsed)
+		{
+			memcpy(&m_writeBuf[m_writeBufUsed], data, count);
+			m_writeBufUsed += count;
+		}
+		else
+			WriteUnbuffered(data, count);
+
+		CalcAddDelta(count);
+	}
+
+	// The stream's position doesn't include the buffered data, so the buffer
+	// must be flushed before the stream's position is used or changed.
+	inline void SyncWriteBuffer()
+	{
+		if (m_writeBufUsed)
+			FlushWriteBuffer();
+	}
+
+	void WriteUnbuffered(const char* const data, const size_t count);
+	void FlushWriteBuffer();
+
 	void CalcAddDelta(const size_t count);
 	void CalcSkipDelta(const std::streamoff offset, const std::ios_base::seekdir way);
 
 private:
 	std::fstream            m_stream; // I/O stream.
+	std::unique_ptr<char[]> m_writeBuf;         // Pending writes, allocated on first write.
+	size_t                  m_writeBufUsed;     // Number of pending bytes.
+	size_t                  m_writeBufCapacity; // Size of the write buffer.
 	std::streamoff          m_size;   // File size.
 	std::streamoff          m_skip;   // Amount skipped back.
 	std::ios_base::openmode m_flags;  // Stream flags.
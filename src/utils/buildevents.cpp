@@ -0,0 +1,198 @@
+#include "pch.h"
+#include "buildevents.h"
+
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+
+static std::atomic<bool> s_eventsEnabled;
+static steady_clock::time_point s_eventsStartTime;
+
+// last reported compression progress in percent, see BuildEvents_CompressProgress().
+static std::atomic<int> s_compressProgress(-1);
+
+//-----------------------------------------------------------------------------
+// Writes a single event object and passes it to the logger once complete.
+//-----------------------------------------------------------------------------
+class CBuildEventWriter
+{
+public:
+	CBuildEventWriter(const char* const eventName)
+		: m_writer(m_buffer)
+	{
+		const milliseconds elapsed = duration_cast<milliseconds>(high_resolution_clock::now() - s_eventsStartTime);
+
+		m_writer.StartObject();
+		m_writer.Key("event");
+		m_writer.String(eventName);
+		m_writer.Key("time");
+		m_writer.Int64(elapsed.count());
+	}
+
+	~CBuildEventWriter()
+	{
+		m_writer.EndObject();
+		Logger_WriteEvent(m_buffer.GetString(), m_buffer.GetSize());
+	}
+
+	inline void String(const char* const key, const char* const value)
+	{
+		m_writer.Key(key);
+
+		if (value)
+			m_writer.String(value);
+		else
+			m_writer.Null();
+	}
+
+	inline void Uint64(const char* const key, const uint64_t value)
+	{
+		m_writer.Key(key);
+		m_writer.Uint64(value);
+	}
+
+	inline void Int64(const char* const key, const int64_t value)
+	{
+		m_writer.Key(key);
+		m_writer.Int64(value);
+	}
+
+private:
+	rapidjson::StringBuffer m_buffer;
+	rapidjson::Writer<rapidjson::StringBuffer> m_writer;
+};
+
+//-----------------------------------------------------------------------------
+// Purpose: opens the event output and enables the event stream
+// Input  : *filePath - if null, events are written to stderr
+// Output : true on success, false otherwise
+//-----------------------------------------------------------------------------
+bool BuildEvents_Init(const char* const filePath)
+{
+	if (!Logger_OpenEventFile(filePath))
+		return false;
+
+	s_eventsStartTime = high_resolution_clock::now();
+	s_eventsEnabled.store(true, std::memory_order_release);
+
+	return true;
+}
+
+bool BuildEvents_IsEnabled()
+{
+	return s_eventsEnabled.load(std::memory_order_acquire);
+}
+
+void BuildEvents_PakStarted(const char* const pakPath, const size_t assetCount)
+{
+	if (!BuildEvents_IsEnabled())
+		return;
+
+	CBuildEventWriter event("pakStarted");
+
+	event.String("pak", pakPath);
+	event.Uint64("assetCount", assetCount);
+}
+
+void BuildEvents_PakFinished(const char* const pakPath, const size_t assetCount,
+	const size_t decompressedSize, const size_t compressedSize, const int64_t durationMs)
+{
+	if (!BuildEvents_IsEnabled())
+		return;
+
+	CBuildEventWriter event("pakFinished");
+
+	event.String("pak", pakPath);
+	event.Uint64("assetCount", assetCount);
+	event.Uint64("decompressedSize", decompressedSize);
+	event.Uint64("compressedSize", compressedSize);
+	event.Int64("durationMs", durationMs);
+}
+
+void BuildEvents_AssetStarted(const char* const assetPath, const char* const assetType)
+{
+	if (!BuildEvents_IsEnabled())
+		return;
+
+	CBuildEventWriter event("assetStarted");
+
+	event.String("asset", assetPath);
+	event.String("type", assetType);
+}
+
+void BuildEvents_AssetFinished(const char* const assetPath, const char* const assetType,
+	const int64_t durationUs, const size_t pageBytes, const size_t streamBytes)
+{
+	if (!BuildEvents_IsEnabled())
+		return;
+
+	CBuildEventWriter event("assetFinished");
+
+	event.String("asset", assetPath);
+	event.String("type", assetType);
+	event.Int64("durationUs", durationUs);
+	event.Uint64("pageBytes", pageBytes);
+	event.Uint64("streamBytes", streamBytes);
+}
+
+void BuildEvents_AssetFailed(const char* const assetPath, const char* const assetType)
+{
+	if (!BuildEvents_IsEnabled())
+		return;
+
+	CBuildEventWriter event("assetFailed");
+
+	event.String("asset", assetPath);
+	event.String("type", assetType);
+}
+
+void BuildEvents_StreamDedup(const char* const assetPath, const char* const streamSet,
+	const char* const streamFile, const size_t dataSize)
+{
+	if (!BuildEvents_IsEnabled())
+		return;
+
+	CBuildEventWriter event("streamDedup");
+
+	event.String("asset", assetPath);
+	event.String("set", streamSet);
+	event.String("streamFile", streamFile);
+	event.Uint64("size", dataSize);
+}
+
+void BuildEvents_CompressStarted()
+{
+	s_compressProgress.store(-1, std::memory_order_relaxed);
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: reports the compression progress of the pak; the encoder calls this
+//          for every chunk, so only whole percent changes are emitted
+//-----------------------------------------------------------------------------
+void BuildEvents_CompressProgress(const size_t bytesIn, const size_t totalBytes, const size_t bytesOut)
+{
+	if (!BuildEvents_IsEnabled() || !totalBytes)
+		return;
+
+	const int progress = static_cast<int>((100 * static_cast<uint64_t>(bytesIn)) / totalBytes);
+
+	if (s_compressProgress.exchange(progress, std::memory_order_relaxed) == progress)
+		return;
+
+	CBuildEventWriter event("compressProgress");
+
+	event.Uint64("bytesIn", bytesIn);
+	event.Uint64("totalBytes", totalBytes);
+	event.Uint64("bytesOut", bytesOut);
+	event.Int64("percent", progress);
+}
+
+void BuildEvents_Message(const char* const level, const char* const assetPath, const char* const message)
+{
+	if (!BuildEvents_IsEnabled())
+		return;
+
+	CBuildEventWriter event(level);
+
+	event.String("asset", assetPath);
+	event.String("message", message);
+}
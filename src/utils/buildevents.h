@@ -0,0 +1,35 @@
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Machine readable build event stream, enabled with '--events=json'. Each
+// event is written as a single line JSON object through the logger's flush
+// thread, so events from different threads never interleave. Every event has
+// an "event" name and a "time" in milliseconds since the stream was enabled.
+//-----------------------------------------------------------------------------
+
+// enables the event stream, written to given file or pipe, or stderr if null.
+extern bool BuildEvents_Init(const char* const filePath);
+extern bool BuildEvents_IsEnabled();
+
+extern void BuildEvents_PakStarted(const char* const pakPath, const size_t assetCount);
+extern void BuildEvents_PakFinished(const char* const pakPath, const size_t assetCount,
+	const size_t decompressedSize, const size_t compressedSize, const int64_t durationMs);
+
+extern void BuildEvents_AssetStarted(const char* const assetPath, const char* const assetType);
+extern void BuildEvents_AssetFinished(const char* const assetPath, const char* const assetType,
+	const int64_t durationUs, const size_t pageBytes, const size_t streamBytes);
+// sent instead of assetFinished for an asset dropped from a --keep-going build,
+// its error is sent as an error event. assetPath and assetType can be null.
+extern void BuildEvents_AssetFailed(const char* const assetPath, const char* const assetType);
+
+// data that was mapped to identical data in a stream file instead of added.
+extern void BuildEvents_StreamDedup(const char* const assetPath, const char* const streamSet,
+	const char* const streamFile, const size_t dataSize);
+
+// called when compression of a pak starts, so its first progress is emitted.
+extern void BuildEvents_CompressStarted();
+// only emitted when the progress advanced by at least a percent.
+extern void BuildEvents_CompressProgress(const size_t bytesIn, const size_t totalBytes, const size_t bytesOut);
+
+// level is "warning" or "error", assetPath can be null.
+extern void BuildEvents_Message(const char* const level, const char* const assetPath, const char* const message);
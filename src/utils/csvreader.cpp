@@ -0,0 +1,126 @@
+#include "pch.h"
+#include "csvreader.h"
+
+//-----------------------------------------------------------------------------
+// Purpose: maps the csv file and builds the cell index
+// Input  : *filePath -
+// Output : true if operation is successful
+//-----------------------------------------------------------------------------
+bool CCsvReader::Open(const char* const filePath)
+{
+	m_cells.clear();
+	m_lineOffsets.clear();
+	m_unescaped.clear();
+
+	if (!m_file.Open(filePath))
+		return false;
+
+	Parse(reinterpret_cast<const char*>(m_file.GetData()), m_file.GetSize());
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: tokenizes the entire file in one pass
+// Input  : *data -
+//          size -
+//-----------------------------------------------------------------------------
+void CCsvReader::Parse(const char* const data, const size_t size)
+{
+	const char* cur = data;
+	const char* const end = data + size;
+
+	// skip the UTF-8 byte order mark, if any.
+	if (size >= 3 && memcmp(data, "\xEF\xBB\xBF", 3) == 0)
+		cur += 3;
+
+	while (cur < end)
+	{
+		// a trailing carriage return without line feed isn't a line.
+		if (*cur == '\r' && (cur + 1) == end)
+			break;
+
+		m_lineOffsets.push_back(m_cells.size());
+
+		while (true)
+		{
+			const char* const cellStart = cur;
+
+			if (cur < end && *cur == '"')
+			{
+				// separators are taken literally until the closing quote,
+				// escaped quotes ("") toggle the state twice.
+				bool quoted = true;
+				cur++;
+
+				while (cur < end && *cur != '\n' && (quoted || *cur != ','))
+				{
+					if (*cur == '"')
+						quoted = !quoted;
+
+					cur++;
+				}
+			}
+			else
+			{
+				while (cur < end && *cur != ',' && *cur != '\n')
+					cur++;
+			}
+
+			if (cur < end && *cur == ',')
+			{
+				m_cells.push_back(Unquote(cellStart, cur));
+				cur++;
+
+				continue;
+			}
+
+			// last cell of the line, drop the carriage return of CRLF files.
+			const char* cellEnd = cur;
+
+			if (cellEnd > cellStart && cellEnd[-1] == '\r')
+				cellEnd--;
+
+			m_cells.push_back(Unquote(cellStart, cellEnd));
+
+			if (cur < end)
+				cur++; // Skip the line feed.
+
+			break;
+		}
+	}
+
+	m_lineOffsets.push_back(m_cells.size());
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: strips the enclosing quotes of a cell and unescapes inner quotes
+// Input  : *cellStart -
+//          *cellEnd -
+// Output : the cell's value
+//-----------------------------------------------------------------------------
+std::string_view CCsvReader::Unquote(const char* const cellStart, const char* const cellEnd)
+{
+	const size_t cellLen = cellEnd - cellStart;
+
+	if (cellLen < 2 || cellStart[0] != '"' || cellEnd[-1] != '"')
+		return std::string_view(cellStart, cellLen);
+
+	const std::string_view inner(&cellStart[1], cellLen - 2);
+
+	// only cells with escaped quotes need a copy.
+	if (inner.find('"') == std::string_view::npos)
+		return inner;
+
+	std::string& unescaped = m_unescaped.emplace_back();
+	unescaped.reserve(inner.length());
+
+	for (size_t i = 0; i < inner.length(); i++)
+	{
+		unescaped += inner[i];
+
+		if (inner[i] == '"' && (i + 1) < inner.length() && inner[i + 1] == '"')
+			i++;
+	}
+
+	return unescaped;
+}
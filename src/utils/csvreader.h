@@ -0,0 +1,57 @@
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Read-only CSV document. The file is memory mapped and tokenized in a single
+// pass into a flat cell index; cells are views into the mapped file, so no
+// per cell or per row copies are made. The first row holds the column names,
+// and quoted cells are unquoted, like rapidcsv's default parameters; line
+// breaks always end the row, even within quotes.
+//-----------------------------------------------------------------------------
+class CCsvReader
+{
+public:
+	CCsvReader() = default;
+
+	CCsvReader(const CCsvReader&) = delete;
+	CCsvReader& operator=(const CCsvReader&) = delete;
+
+	bool Open(const char* const filePath);
+	inline bool Open(const std::string& filePath) { return Open(filePath.c_str()); };
+
+	// number of columns in the column name row.
+	inline size_t GetColumnCount() const { return GetLineCellCount(0); }
+
+	// number of rows, excluding the column name row.
+	inline size_t GetRowCount() const { return m_lineOffsets.size() > 1 ? m_lineOffsets.size() - 2 : 0; }
+
+	// number of cells in given row.
+	inline size_t GetRowColumnCount(const size_t rowIdx) const { return GetLineCellCount(rowIdx + 1); }
+
+	inline std::string_view GetColumnName(const size_t colIdx) const { return GetLineCell(colIdx, 0); }
+
+	// the cell must exist; check the row's column count first.
+	inline std::string_view GetCell(const size_t colIdx, const size_t rowIdx) const { return GetLineCell(colIdx, rowIdx + 1); }
+
+private:
+	void Parse(const char* const data, const size_t size);
+	std::string_view Unquote(const char* const cellStart, const char* const cellEnd);
+
+	inline size_t GetLineCellCount(const size_t lineIdx) const
+	{
+		if (lineIdx + 1 >= m_lineOffsets.size())
+			return 0;
+
+		return m_lineOffsets[lineIdx + 1] - m_lineOffsets[lineIdx];
+	}
+
+	inline std::string_view GetLineCell(const size_t colIdx, const size_t lineIdx) const
+	{
+		assert(colIdx < GetLineCellCount(lineIdx));
+		return m_cells[m_lineOffsets[lineIdx] + colIdx];
+	}
+
+	CMappedFile                   m_file;
+	std::vector<std::string_view> m_cells;       // Cells of all lines, in order.
+	std::vector<size_t>           m_lineOffsets; // Index of each line's first cell in m_cells, plus one past the last.
+	std::deque<std::string>       m_unescaped;   // Storage for quoted cells that contained escaped quotes.
+};
@@ -7,13 +7,16 @@
 #include "jsonutils.h"
 
 //-----------------------------------------------------------------------------
-// Purpose: parsing a json file from stream.
+// Purpose: parsing a json file in-situ. the file is copied into a buffer that
+//          is allocated from the document's own memory pool, so the strings in
+//          the document can reference the buffer directly and are released
+//          together with the document.
 //-----------------------------------------------------------------------------
 bool JSON_ParseFromFile(const char* const assetPath, const char* const debugName, rapidjson::Document& document, const bool mandatory)
 {
-    std::ifstream ifs(assetPath);
+    CMappedFile file;
 
-    if (!ifs)
+    if (!file.Open(assetPath))
     {
         // Note: mandatory only prevents the error if the file doesn't exist,
         // if there are parsing or validation problems, we will still error as
@@ -24,9 +27,16 @@ bool JSON_ParseFromFile(const char* const assetPath, const char* const debugName
         return false;
     }
 
-    rapidjson::IStreamWrapper jsonStreamWrapper(ifs);
+    const size_t fileSize = file.GetSize();
+    char* const buffer = reinterpret_cast<char*>(document.GetAllocator().Malloc(fileSize + 1));
 
-    if (document.ParseStream(jsonStreamWrapper).HasParseError())
+    if (fileSize > 0)
+        memcpy(buffer, file.GetData(), fileSize);
+
+    buffer[fileSize] = '\0';
+    file.Close();
+
+    if (document.ParseInsitu(buffer).HasParseError())
     {
         g_jsonErrorCallback("%s: %s parse error at position %zu: [%s].\n", __FUNCTION__, debugName,
             document.GetErrorOffset(), rapidjson::GetParseError_En(document.GetParseError()));
@@ -43,6 +53,51 @@ bool JSON_ParseFromFile(const char* const assetPath, const char* const debugName
     return true;
 }
 
+static std::unordered_map<std::string, std::shared_ptr<const rapidjson::Document>> s_documentCache;
+static JSONDocumentCacheStats_s s_documentCacheStats;
+
+//-----------------------------------------------------------------------------
+// Purpose: parsing a json file, or returning the cached document if the file
+//          has already been requested during this build. the document is only
+//          cached once parsed, as the error callback can throw in keep-going
+//          builds; a malformed file must not be cached as a missing one.
+//-----------------------------------------------------------------------------
+std::shared_ptr<const rapidjson::Document> JSON_GetCachedDocument(const char* const filePath, const char* const debugName, const bool mandatory)
+{
+    const auto it = s_documentCache.find(filePath);
+
+    if (it != s_documentCache.end())
+    {
+        s_documentCacheStats.numHits++;
+
+        // The file was previously requested as optional and didn't exist.
+        if (!it->second && mandatory)
+            g_jsonErrorCallback("%s: couldn't open %s file.\n", __FUNCTION__, debugName);
+
+        return it->second;
+    }
+
+    std::shared_ptr<rapidjson::Document> document = std::make_shared<rapidjson::Document>();
+
+    if (JSON_ParseFromFile(filePath, debugName, *document, mandatory))
+        s_documentCacheStats.numParsed++;
+    else
+    {
+        document.reset();
+        s_documentCacheStats.numMissing++;
+    }
+
+    return s_documentCache.emplace(filePath, std::move(document)).first->second;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: gets the document cache statistics of this build.
+//-----------------------------------------------------------------------------
+const JSONDocumentCacheStats_s& JSON_GetDocumentCacheStats()
+{
+    return s_documentCacheStats;
+}
+
 //-----------------------------------------------------------------------------
 // Purpose: dumping a json document to a string buffer.
 //-----------------------------------------------------------------------------
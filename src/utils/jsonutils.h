@@ -506,6 +506,21 @@ inline V JSON_GetNumberRequired(const T& data, typename T::StringRefType member)
 }
 
 bool JSON_ParseFromFile(const char* const assetPath, const char* const debugName, rapidjson::Document& document, const bool mandatory);
+
+//-----------------------------------------------------------------------------
+// Parsed documents are cached for the duration of the build, as the same files
+// are often referenced by multiple assets and paks. Files that don't exist or
+// failed to parse are cached as null, so optional files are only probed once.
+//-----------------------------------------------------------------------------
+struct JSONDocumentCacheStats_s
+{
+    size_t numParsed;  // Number of files parsed from disk.
+    size_t numMissing; // Number of files that couldn't be opened or parsed.
+    size_t numHits;    // Number of requests served from the cache.
+};
+
+std::shared_ptr<const rapidjson::Document> JSON_GetCachedDocument(const char* const filePath, const char* const debugName, const bool mandatory);
+const JSONDocumentCacheStats_s& JSON_GetDocumentCacheStats();
 void JSON_DocumentToBufferDeserialize(const rapidjson::Document& document, rapidjson::StringBuffer& buffer, unsigned int indent = 4);
 
 #endif // JSONUTILS_H
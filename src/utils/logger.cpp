@@ -1,7 +1,11 @@
 #include "pch.h"
 #include "logger.h"
+#include "buildevents.h"
 
-const char* g_currentAsset = nullptr;
+#include <mutex>
+#include <condition_variable>
+
+thread_local const char* g_currentAsset = nullptr;
 bool g_showDebugLogs = false;
 
 static std::string s_debugColorCode;
@@ -17,37 +21,605 @@ void Logger_colorInit()
 	s_resetColorCode = "\033[0m";
 }
 
-void Warning(_Printf_format_string_ const char* fmt, ...)
+// Number of messages that can be pending at once, must be a power of two. If
+// the ring is full, the logging thread waits for the flush thread to catch up
+// instead of dropping the message.
+#define LOGGER_RING_SIZE 1024
+
+// Messages up to this size are formatted directly into their ring slot, longer
+// messages are allocated on the heap.
+#define LOGGER_INLINE_MSG_SIZE 512
+
+// Time after which the flush thread writes out pending messages on its own.
+#define LOGGER_FLUSH_INTERVAL_MS 5
+
+enum class LogLevel_e : uint8_t
+{
+	Log,
+	Debug,
+	Warning,
+	Error,
+	Event // Build event, only written to the event stream.
+};
+
+struct LogSlot_s
+{
+	// slot N of lap L is free to write when this equals N + (L * ring size),
+	// and holds a published message when this equals N + (L * ring size) + 1.
+	std::atomic<size_t> sequence;
+
+	LogLevel_e level;
+	uint32_t prefixLen; // Part of the text that isn't colored, e.g. "WARNING: ".
+	uint32_t textLen;
+
+	char* heapText; // Set if the message didn't fit in the inline text.
+	char text[LOGGER_INLINE_MSG_SIZE];
+};
+
+static LogSlot_s s_ring[LOGGER_RING_SIZE];
+
+alignas(64) static std::atomic<size_t> s_enqueuePos; // Next slot to claim, shared by the producers.
+alignas(64) static size_t s_dequeuePos;              // Next slot to write out, only used by the consumer.
+alignas(64) static std::atomic<size_t> s_activeProducers; // Threads that may hold a claimed but unpublished slot.
+
+static std::atomic<bool> s_running;
+static std::atomic<FILE*> s_logFile;
+static std::atomic<FILE*> s_eventFile;
+static std::thread s_flushThread;
+
+static std::mutex s_flushMutex;
+static std::condition_variable s_wakeCond;    // Wakes the flush thread.
+static std::condition_variable s_flushedCond; // Signals that s_flushedPos advanced.
+static size_t s_flushedPos;
+static bool s_flushRequested;
+static bool s_stopRequested;
+
+static std::mutex s_shutdownMutex;
+
+static thread_local bool s_collectErrors;
+
+// Messages drained from the ring, written out with one call per output.
+struct LogBatch_s
+{
+	std::string console;
+	std::string file;
+	std::string events;
+};
+
+//-----------------------------------------------------------------------------
+// Purpose: formats the level tag, the current asset and the message into the
+//          buffer, like snprintf the output is truncated if it doesn't fit
+// Input  : *buf -
+//          bufSize -
+//          level -
+//          &prefixLen -
+//          *fmt -
+//          args -
+// Output : length of the full message, excluding the null terminator
+//-----------------------------------------------------------------------------
+static size_t Logger_FormatMessage(char* const buf, const size_t bufSize, const LogLevel_e level, uint32_t& prefixLen, const char* const fmt, va_list args)
+{
+	const char* tag = nullptr;
+	int prefix = 0;
+
+	switch (level)
+	{
+	case LogLevel_e::Warning:
+		tag = "WARNING";
+		break;
+	case LogLevel_e::Error:
+		tag = "ERROR";
+		break;
+	case LogLevel_e::Debug:
+		prefix = snprintf(buf, bufSize, "[D] ");
+		break;
+	}
+
+	// the asset name is passed as an argument rather than being pasted into
+	// the format string, so any '%' in it is printed as is.
+	if (tag)
+		prefix = g_currentAsset ? snprintf(buf, bufSize, "%s( %s ): ", tag, g_currentAsset) : snprintf(buf, bufSize, "%s: ", tag);
+
+	if (prefix < 0)
+		prefix = 0;
+
+	prefixLen = static_cast<uint32_t>(prefix);
+
+	const size_t offset = (std::min)(static_cast<size_t>(prefix), bufSize - 1);
+	const int msgLen = vsnprintf(&buf[offset], bufSize - offset, fmt, args);
+
+	return prefix + (msgLen > 0 ? msgLen : 0);
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: formats the message into given slot
+//-----------------------------------------------------------------------------
+static void Logger_FormatSlot(LogSlot_s& slot, const LogLevel_e level, const char* const fmt, va_list args)
+{
+	va_list argsCopy;
+	va_copy(argsCopy, args);
+
+	slot.level = level;
+	slot.heapText = nullptr;
+
+	const size_t textLen = Logger_FormatMessage(slot.text, sizeof(slot.text), level, slot.prefixLen, fmt, argsCopy);
+	va_end(argsCopy);
+
+	if (textLen >= sizeof(slot.text))
+	{
+		slot.heapText = new char[textLen + 1];
+		Logger_FormatMessage(slot.heapText, textLen + 1, level, slot.prefixLen, fmt, args);
+	}
+
+	slot.textLen = static_cast<uint32_t>(textLen);
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: returns the color code of given level
+//-----------------------------------------------------------------------------
+static const std::string* Logger_GetColorCode(const LogLevel_e level)
+{
+	switch (level)
+	{
+	case LogLevel_e::Debug:
+		return &s_debugColorCode;
+	case LogLevel_e::Warning:
+		return &s_warningColorCode;
+	case LogLevel_e::Error:
+		return &s_errorColorCode;
+	}
+
+	return nullptr;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: appends the message to the console batch with color codes, and to
+//          the file batch without; events only go to the event batch
+//-----------------------------------------------------------------------------
+static void Logger_AppendMessage(LogBatch_s& batch, const LogLevel_e level,
+	const char* const text, const size_t textLen, const size_t prefixLen, const bool hasFile)
+{
+	if (level == LogLevel_e::Event)
+	{
+		batch.events.append(text, textLen);
+		return;
+	}
+
+	const std::string* const colorCode = Logger_GetColorCode(level);
+
+	if (colorCode)
+	{
+		batch.console.append(text, prefixLen);
+		batch.console.append(*colorCode);
+		batch.console.append(&text[prefixLen], textLen - prefixLen);
+		batch.console.append(s_resetColorCode);
+	}
+	else
+		batch.console.append(text, textLen);
+
+	if (hasFile)
+		batch.file.append(text, textLen);
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: writes the data to the output and clears it
+//-----------------------------------------------------------------------------
+static void Logger_WriteOutput(std::string& data, FILE* const output)
+{
+	if (output && !data.empty())
+	{
+		fwrite(data.data(), 1, data.size(), output);
+		fflush(output);
+	}
+
+	data.clear();
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: writes out the batches in one call per output
+//-----------------------------------------------------------------------------
+static void Logger_WriteBatch(LogBatch_s& batch, FILE* const logFile, FILE* const eventFile)
+{
+	Logger_WriteOutput(batch.console, stdout);
+	Logger_WriteOutput(batch.file, logFile);
+	Logger_WriteOutput(batch.events, eventFile);
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: writes out all published messages, only the flush thread may call
+//          this while it's running
+//-----------------------------------------------------------------------------
+static void Logger_DrainRing(LogBatch_s& batch)
+{
+	FILE* const logFile = s_logFile.load(std::memory_order_acquire);
+	FILE* const eventFile = s_eventFile.load(std::memory_order_acquire);
+	size_t pos = s_dequeuePos;
+
+	while (true)
+	{
+		LogSlot_s& slot = s_ring[pos & (LOGGER_RING_SIZE - 1)];
+
+		if (slot.sequence.load(std::memory_order_acquire) != pos + 1)
+			break; // Not yet published.
+
+		const char* const text = slot.heapText ? slot.heapText : slot.text;
+		const size_t prefixLen = (std::min)(slot.prefixLen, slot.textLen);
+
+		Logger_AppendMessage(batch, slot.level, text, slot.textLen, prefixLen, logFile != nullptr);
+
+		delete[] slot.heapText;
+		slot.heapText = nullptr;
+
+		// hand the slot back to the producers for the next lap.
+		slot.sequence.store(pos + LOGGER_RING_SIZE, std::memory_order_release);
+		pos++;
+	}
+
+	s_dequeuePos = pos;
+	Logger_WriteBatch(batch, logFile, eventFile);
+
+	{
+		std::lock_guard<std::mutex> lock(s_flushMutex);
+		s_flushedPos = pos;
+	}
+
+	s_flushedCond.notify_all();
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: the flush thread, writes out pending messages in batches on every
+//          interval or flush request until it is stopped
+//-----------------------------------------------------------------------------
+static void Logger_FlushThread()
+{
+	LogBatch_s batch;
+
+	while (true)
+	{
+		bool stopRequested;
+		{
+			std::unique_lock<std::mutex> lock(s_flushMutex);
+			s_wakeCond.wait_for(lock, std::chrono::milliseconds(LOGGER_FLUSH_INTERVAL_MS), [] { return s_flushRequested || s_stopRequested; });
+
+			s_flushRequested = false;
+			stopRequested = s_stopRequested;
+		}
+
+		Logger_DrainRing(batch);
+
+		if (stopRequested)
+			break;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: wakes the flush thread before its interval runs out
+//-----------------------------------------------------------------------------
+static void Logger_RequestFlush()
+{
+	{
+		std::lock_guard<std::mutex> lock(s_flushMutex);
+		s_flushRequested = true;
+	}
+
+	s_wakeCond.notify_one();
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: formats and prints the message on the calling thread, used when the
+//          flush thread isn't running
+//-----------------------------------------------------------------------------
+static void Logger_PrintDirect(const LogLevel_e level, const char* const fmt, va_list args)
+{
+	LogSlot_s slot;
+	Logger_FormatSlot(slot, level, fmt, args);
+
+	const char* const text = slot.heapText ? slot.heapText : slot.text;
+	const size_t prefixLen = (std::min)(slot.prefixLen, slot.textLen);
+
+	LogBatch_s batch;
+
+	Logger_AppendMessage(batch, level, text, slot.textLen, prefixLen, false);
+	Logger_WriteBatch(batch, nullptr, s_eventFile.load(std::memory_order_acquire));
+
+	delete[] slot.heapText;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: prints the message directly for a producer that found the logger
+//          stopped; waits for a shutdown in progress to write out the ring
+//          first, so the message doesn't overtake those queued before it
+//-----------------------------------------------------------------------------
+static void Logger_LeaveAndPrintDirect(const LogLevel_e level, const char* const fmt, va_list args)
+{
+	s_activeProducers.fetch_sub(1, std::memory_order_release);
+	{
+		std::lock_guard<std::mutex> lock(s_shutdownMutex);
+	}
+
+	Logger_PrintDirect(level, fmt, args);
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: formats the message into the next free ring slot and publishes it
+//          to the flush thread, can be called from any thread
+//-----------------------------------------------------------------------------
+static void Logger_Enqueue(const LogLevel_e level, const char* const fmt, va_list args)
+{
+	// announce this producer before checking whether the logger runs; paired
+	// with the order in Logger_Shutdown(), either shutdown waits for this slot
+	// to be published, or this sees the logger stopped.
+	s_activeProducers.fetch_add(1, std::memory_order_seq_cst);
+
+	if (!s_running.load(std::memory_order_seq_cst))
+	{
+		Logger_LeaveAndPrintDirect(level, fmt, args);
+		return;
+	}
+
+	size_t pos = s_enqueuePos.load(std::memory_order_relaxed);
+	LogSlot_s* slot;
+
+	while (true)
+	{
+		slot = &s_ring[pos & (LOGGER_RING_SIZE - 1)];
+
+		const size_t sequence = slot->sequence.load(std::memory_order_acquire);
+		const intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+
+		if (diff == 0)
+		{
+			// slot is free, claim it unless another producer beat us to it.
+			if (s_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+				break;
+		}
+		else if (diff < 0)
+		{
+			// ring is full, nothing drains it anymore once stopped.
+			if (!s_running.load(std::memory_order_acquire))
+			{
+				Logger_LeaveAndPrintDirect(level, fmt, args);
+				return;
+			}
+
+			// let the flush thread catch up.
+			Logger_RequestFlush();
+			std::this_thread::yield();
+
+			pos = s_enqueuePos.load(std::memory_order_relaxed);
+		}
+		else
+			pos = s_enqueuePos.load(std::memory_order_relaxed);
+	}
+
+	Logger_FormatSlot(*slot, level, fmt, args);
+	slot->sequence.store(pos + 1, std::memory_order_release);
+
+	s_activeProducers.fetch_sub(1, std::memory_order_release);
+}
+
+static void Logger_EnqueueFormat(const LogLevel_e level, _Printf_format_string_ const char* const fmt, ...)
 {
 	va_list args;
 	va_start(args, fmt);
+	Logger_Enqueue(level, fmt, args);
+	va_end(args);
+}
 
-	std::string msg;
+//-----------------------------------------------------------------------------
+// Purpose: formats the message without any prefix
+//-----------------------------------------------------------------------------
+static std::string Logger_FormatString(const char* const fmt, va_list args)
+{
+	va_list argsCopy;
+	va_copy(argsCopy, args);
 
-	if (g_currentAsset)
-		msg = Utils::VFormat("WARNING( %s ): %s%s%s", g_currentAsset, s_warningColorCode.c_str(), fmt, s_resetColorCode.c_str());
-	else
-		msg = "WARNING: " + s_warningColorCode + fmt + s_resetColorCode;
+	const int msgLen = vsnprintf(nullptr, 0, fmt, argsCopy);
+	va_end(argsCopy);
+
+	if (msgLen <= 0)
+		return std::string();
+
+	std::string msg(msgLen, '\0');
+	vsnprintf(msg.data(), msg.size() + 1, fmt, args);
+
+	return msg;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: starts the flush thread
+//-----------------------------------------------------------------------------
+void Logger_Init()
+{
+	if (s_running.load(std::memory_order_acquire))
+		return;
+
+	for (size_t i = 0; i < LOGGER_RING_SIZE; i++)
+		s_ring[i].sequence.store(i, std::memory_order_relaxed);
+
+	s_enqueuePos.store(0, std::memory_order_relaxed);
+	s_dequeuePos = 0;
+	s_flushedPos = 0;
+	s_flushRequested = false;
+	s_stopRequested = false;
+
+	s_flushThread = std::thread(Logger_FlushThread);
+	s_running.store(true, std::memory_order_release);
+
+	static bool registeredExit = false;
+
+	if (!registeredExit)
+	{
+		atexit(Logger_Shutdown);
+		registeredExit = true;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: blocks until every message that was logged before this call has
+//          been written out
+//-----------------------------------------------------------------------------
+void Logger_Flush()
+{
+	if (!s_running.load(std::memory_order_acquire))
+		return;
+
+	const size_t targetPos = s_enqueuePos.load(std::memory_order_acquire);
+	Logger_RequestFlush();
+
+	std::unique_lock<std::mutex> lock(s_flushMutex);
+	s_flushedCond.wait(lock, [targetPos] { return s_flushedPos >= targetPos || s_stopRequested; });
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: writes out all pending messages, stops the flush thread and closes
+//          the log file; further messages are printed directly
+//-----------------------------------------------------------------------------
+void Logger_Shutdown()
+{
+	std::lock_guard<std::mutex> shutdownLock(s_shutdownMutex);
+
+	if (!s_running.exchange(false, std::memory_order_seq_cst))
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(s_flushMutex);
+		s_stopRequested = true;
+	}
 
-	vprintf(msg.c_str(), args);
+	s_wakeCond.notify_one();
+
+	if (s_flushThread.joinable())
+		s_flushThread.join();
+
+	// producers that saw the logger running may still be formatting into the
+	// slots they claimed; the consumer is gone so it's safe to drain here
+	// until every claimed slot has been published and written out.
+	LogBatch_s batch;
+
+	while (true)
+	{
+		const bool producersDone = s_activeProducers.load(std::memory_order_seq_cst) == 0;
+		Logger_DrainRing(batch);
+
+		if (producersDone && s_dequeuePos == s_enqueuePos.load(std::memory_order_relaxed))
+			break;
+
+		std::this_thread::yield();
+	}
+
+	FILE* const logFile = s_logFile.exchange(nullptr, std::memory_order_acq_rel);
+
+	if (logFile)
+		fclose(logFile);
+
+	FILE* const eventFile = s_eventFile.exchange(nullptr, std::memory_order_acq_rel);
+
+	if (eventFile && eventFile != stderr)
+		fclose(eventFile);
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: swaps the output file written by the flush thread
+//-----------------------------------------------------------------------------
+static void Logger_SwapOutputFile(std::atomic<FILE*>& output, FILE* const file)
+{
+	// only the flush thread writes to the file, so write out what is pending
+	// before swapping it to keep the messages in order.
+	Logger_Flush();
+	FILE* const prevFile = output.exchange(file, std::memory_order_acq_rel);
+
+	if (prevFile && prevFile != stderr)
+	{
+		Logger_Flush();
+		fclose(prevFile);
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: opens the log file, all further messages are written to the file
+//          as well
+// Input  : *filePath -
+// Output : true on success, false otherwise
+//-----------------------------------------------------------------------------
+bool Logger_OpenLogFile(const char* const filePath)
+{
+	FILE* logFile = nullptr;
+
+	if (fopen_s(&logFile, filePath, "wb") != 0 || !logFile)
+		return false;
+
+	Logger_SwapOutputFile(s_logFile, logFile);
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: opens the file or pipe the build events are written to
+// Input  : *filePath - if null, events are written to stderr
+// Output : true on success, false otherwise
+//-----------------------------------------------------------------------------
+bool Logger_OpenEventFile(const char* const filePath)
+{
+	FILE* eventFile = stderr;
+
+	if (filePath && (fopen_s(&eventFile, filePath, "wb") != 0 || !eventFile))
+		return false;
+
+	Logger_SwapOutputFile(s_eventFile, eventFile);
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: queues a line for the event stream, the line break is appended
+//-----------------------------------------------------------------------------
+void Logger_WriteEvent(const char* const text, const size_t textLen)
+{
+	Logger_EnqueueFormat(LogLevel_e::Event, "%.*s\n", static_cast<int>(textLen), text);
+}
+
+void Logger_SetCollectErrors(const bool collect)
+{
+	s_collectErrors = collect;
+}
+
+void Warning(_Printf_format_string_ const char* fmt, ...)
+{
+	va_list args;
+	va_start(args, fmt);
+	Logger_Enqueue(LogLevel_e::Warning, fmt, args);
 	va_end(args);
+
+	if (BuildEvents_IsEnabled())
+	{
+		va_start(args, fmt);
+		const std::string msg = Logger_FormatString(fmt, args);
+		va_end(args);
+
+		BuildEvents_Message("warning", g_currentAsset, msg.c_str());
+	}
 }
 
 void Error(_Printf_format_string_ const char* fmt, ...)
 {
 	va_list args;
 	va_start(args, fmt);
+	Logger_Enqueue(LogLevel_e::Error, fmt, args);
+	va_end(args);
 
-	std::string msg;
+	if (BuildEvents_IsEnabled() || s_collectErrors)
+	{
+		va_start(args, fmt);
+		std::string msg = Logger_FormatString(fmt, args);
+		va_end(args);
 
-	if (g_currentAsset)
-		msg = Utils::VFormat("ERROR( %s ): %s%s%s", g_currentAsset, s_errorColorCode.c_str(), fmt, s_resetColorCode.c_str());
-	else
-		msg = "ERROR: " + s_errorColorCode + fmt + s_resetColorCode;
+		BuildEvents_Message("error", g_currentAsset, msg.c_str());
 
-	vprintf(msg.c_str(), args);
-	va_end(args);
+		if (s_collectErrors)
+			throw LogError_s{ std::move(msg) };
+	}
 
+	// make sure this and all previous messages are written out before exiting.
+	Logger_Shutdown();
 	exit(EXIT_FAILURE);
 }
 
@@ -55,7 +627,7 @@ void Log(_Printf_format_string_ const char* fmt, ...)
 {
 	va_list args;
 	va_start(args, fmt);
-	vprintf(fmt, args);
+	Logger_Enqueue(LogLevel_e::Log, fmt, args);
 	va_end(args);
 }
 
@@ -66,9 +638,6 @@ void Debug(_Printf_format_string_ const char* fmt, ...)
 
 	va_list args;
 	va_start(args, fmt);
-
-	std::string msg = "[D] " + s_debugColorCode + fmt + s_resetColorCode;
-
-	vprintf(msg.c_str(), args);
+	Logger_Enqueue(LogLevel_e::Debug, fmt, args);
 	va_end(args);
-}
\ No newline at end of file
+}
@@ -1,10 +1,35 @@
 #pragma once
 
-extern const char* g_currentAsset;
+// asset that is being processed by the calling thread, printed with warnings
+// and errors.
+extern thread_local const char* g_currentAsset;
 extern bool g_showDebugLogs;
 
 extern void Logger_colorInit();
 
+// starts the flush thread, messages logged before this are printed directly.
+extern void Logger_Init();
+// blocks until every message logged so far has been written out.
+extern void Logger_Flush();
+// writes out all pending messages and stops the flush thread.
+extern void Logger_Shutdown();
+// writes all further messages to given file as well, without color codes.
+extern bool Logger_OpenLogFile(const char* const filePath);
+// writes the build event stream to given file or pipe, or stderr if null.
+extern bool Logger_OpenEventFile(const char* const filePath);
+// queues a line for the event stream, see buildevents.h.
+extern void Logger_WriteEvent(const char* const text, const size_t textLen);
+
+// thrown by Error() instead of exiting on threads that collect errors.
+struct LogError_s
+{
+	std::string message;
+};
+
+// while set, Error() on the calling thread prints the message and throws it as
+// LogError_s instead of exiting, so the caller can carry on and report more.
+extern void Logger_SetCollectErrors(const bool collect);
+
 // non-fatal errors/issues
 void Warning(_Printf_format_string_ const char* fmt, ...);
 // fatal errors
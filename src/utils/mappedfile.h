@@ -0,0 +1,39 @@
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Read-only memory mapped view of an entire file. Used for large input files
+// that only need to be copied into their final destination (page lumps or the
+// streaming files), so we don't have to stage them in a heap buffer first.
+//-----------------------------------------------------------------------------
+class CMappedFile
+{
+public:
+	CMappedFile();
+	~CMappedFile();
+
+	CMappedFile(const CMappedFile&) = delete;
+	CMappedFile& operator=(const CMappedFile&) = delete;
+
+	bool Open(const char* const filePath);
+	inline bool Open(const std::string& filePath) { return Open(filePath.c_str()); };
+
+	void Close();
+
+	inline bool IsOpen() const { return m_fileHandle != INVALID_HANDLE_VALUE; }
+
+	inline const uint8_t* GetData() const { return m_data; }
+	inline size_t GetSize() const { return m_size; }
+
+	template<typename T>
+	inline const T* GetData(const size_t offset = 0) const
+	{
+		assert(offset <= m_size);
+		return reinterpret_cast<const T*>(&m_data[offset]);
+	}
+
+private:
+	HANDLE         m_fileHandle; // File handle.
+	HANDLE         m_mapHandle;  // File mapping handle.
+	const uint8_t* m_data;       // Mapped view, null if the file is empty.
+	size_t         m_size;       // File size.
+};
@@ -0,0 +1,265 @@
+//=============================================================================//
+//
+// purpose: triangle mesh optimization utilities
+//
+//=============================================================================//
+#include "pch.h"
+#include "meshutils.h"
+
+//-----------------------------------------------------------------------------
+// purpose: simulates a FIFO post-transform cache and returns the number of
+//          misses per triangle
+//-----------------------------------------------------------------------------
+float Mesh_CalcACMR(const uint16_t* const indices, const size_t indexCount, const size_t vertexCount, const size_t cacheSize)
+{
+	const size_t triCount = indexCount / 3;
+
+	if (!triCount)
+		return 0.0f;
+
+	// a vertex is in the cache if it was inserted less than cacheSize misses
+	// ago, start the timestamp past the cache size so every vertex misses at
+	// first.
+	std::vector<size_t> timestamps(vertexCount, 0);
+	size_t timestamp = cacheSize + 1;
+	size_t misses = 0;
+
+	for (size_t i = 0; i < triCount * 3; i++)
+	{
+		const uint16_t index = indices[i];
+		assert(index < vertexCount);
+
+		if (timestamp - timestamps[index] > cacheSize)
+		{
+			timestamps[index] = timestamp++;
+			misses++;
+		}
+	}
+
+	return static_cast<float>(misses) / static_cast<float>(triCount);
+}
+
+//-----------------------------------------------------------------------------
+// purpose: the Forsyth vertex score, vertices that are high up in the cache and
+//          vertices with few remaining triangles are favoured
+//-----------------------------------------------------------------------------
+static float Mesh_CalcVertexScore(const int cachePosition, const unsigned int remainingTris)
+{
+	if (!remainingTris)
+		return -1.0f; // not used by any other triangle.
+
+	float score = 0.0f;
+
+	if (cachePosition >= 0)
+	{
+		// the last triangle's vertices get a fixed score, so we don't favour
+		// immediately reusing the same edge over the rest of the cache.
+		if (cachePosition < 3)
+			score = 0.75f;
+		else
+		{
+			const float scaler = 1.0f / (MESH_VERTEX_CACHE_SIZE - 3);
+			score = powf(1.0f - (cachePosition - 3) * scaler, 1.5f);
+		}
+	}
+
+	// boost vertices with few triangles left, so we don't leave lonely
+	// triangles behind that would need to be fetched again later.
+	score += 2.0f * powf(static_cast<float>(remainingTris), -0.5f);
+	return score;
+}
+
+//-----------------------------------------------------------------------------
+// purpose: reorders the triangles using Tom Forsyth's linear-speed vertex
+//          cache optimization algorithm
+//-----------------------------------------------------------------------------
+void Mesh_OptimizeVertexCache(uint16_t* const indices, const size_t indexCount, const size_t vertexCount)
+{
+	const size_t triCount = indexCount / 3;
+
+	if (triCount < 2)
+		return;
+
+	// build the vertex to triangle adjacency, the first remainingTris[v]
+	// entries of each vertex's range are the triangles that weren't emitted.
+	std::vector<unsigned int> adjacencyOffsets(vertexCount + 1, 0);
+	std::vector<unsigned int> remainingTris(vertexCount, 0);
+
+	for (size_t i = 0; i < triCount * 3; i++)
+		remainingTris[indices[i]]++;
+
+	for (size_t i = 0; i < vertexCount; i++)
+		adjacencyOffsets[i + 1] = adjacencyOffsets[i] + remainingTris[i];
+
+	std::vector<unsigned int> adjacency(triCount * 3);
+	std::vector<unsigned int> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+
+	for (size_t i = 0; i < triCount * 3; i++)
+		adjacency[fill[indices[i]]++] = static_cast<unsigned int>(i / 3);
+
+	std::vector<float> vertexScores(vertexCount);
+
+	for (size_t i = 0; i < vertexCount; i++)
+		vertexScores[i] = Mesh_CalcVertexScore(-1, remainingTris[i]);
+
+	std::vector<bool> emitted(triCount, false);
+
+	size_t bestTri = 0;
+	float bestScore = -FLT_MAX;
+
+	for (size_t i = 0; i < triCount; i++)
+	{
+		const uint16_t* const tri = &indices[i * 3];
+		const float score = vertexScores[tri[0]] + vertexScores[tri[1]] + vertexScores[tri[2]];
+
+		if (score > bestScore)
+		{
+			bestScore = score;
+			bestTri = i;
+		}
+	}
+
+	// the cache is 3 entries larger to hold the vertices that got pushed out
+	// by the current triangle, so their scores can be updated.
+	uint16_t cache[MESH_VERTEX_CACHE_SIZE + 3];
+	size_t cacheCount = 0;
+
+	std::vector<uint16_t> output(triCount * 3);
+	size_t searchCursor = 0;
+
+	for (size_t outTri = 0; outTri < triCount; outTri++)
+	{
+		// no triangle in the cache was a candidate, continue with the next
+		// triangle that hasn't been emitted yet in input order.
+		if (bestTri == SIZE_MAX)
+		{
+			while (emitted[searchCursor])
+				searchCursor++;
+
+			bestTri = searchCursor;
+		}
+
+		const uint16_t* const tri = &indices[bestTri * 3];
+
+		output[outTri * 3 + 0] = tri[0];
+		output[outTri * 3 + 1] = tri[1];
+		output[outTri * 3 + 2] = tri[2];
+
+		emitted[bestTri] = true;
+
+		// remove the triangle from the adjacency of its vertices.
+		for (int k = 0; k < 3; k++)
+		{
+			const uint16_t v = tri[k];
+
+			unsigned int* const adj = &adjacency[adjacencyOffsets[v]];
+			const unsigned int count = remainingTris[v];
+
+			for (unsigned int j = 0; j < count; j++)
+			{
+				if (adj[j] == bestTri)
+				{
+					adj[j] = adj[count - 1];
+					adj[count - 1] = static_cast<unsigned int>(bestTri);
+
+					break;
+				}
+			}
+
+			remainingTris[v]--;
+		}
+
+		// move the triangle's vertices to the front of the cache, the rest
+		// shifts back in order.
+		uint16_t newCache[MESH_VERTEX_CACHE_SIZE + 3];
+		size_t newCacheCount = 0;
+
+		newCache[newCacheCount++] = tri[0];
+		newCache[newCacheCount++] = tri[1];
+		newCache[newCacheCount++] = tri[2];
+
+		for (size_t i = 0; i < cacheCount; i++)
+		{
+			const uint16_t v = cache[i];
+
+			if (v != tri[0] && v != tri[1] && v != tri[2])
+				newCache[newCacheCount++] = v;
+		}
+
+		// update the scores of the vertices in the cache, including the ones
+		// that were just pushed out.
+		for (size_t i = 0; i < newCacheCount; i++)
+		{
+			const uint16_t v = newCache[i];
+			const int position = (i < MESH_VERTEX_CACHE_SIZE) ? static_cast<int>(i) : -1;
+
+			vertexScores[v] = Mesh_CalcVertexScore(position, remainingTris[v]);
+		}
+
+		// rescore all triangles that use a vertex in the cache and pick the
+		// best one as our next candidate.
+		bestTri = SIZE_MAX;
+		bestScore = -FLT_MAX;
+
+		for (size_t i = 0; i < newCacheCount; i++)
+		{
+			const uint16_t v = newCache[i];
+			const unsigned int* const adj = &adjacency[adjacencyOffsets[v]];
+
+			for (unsigned int j = 0; j < remainingTris[v]; j++)
+			{
+				const unsigned int t = adj[j];
+				const uint16_t* const candidate = &indices[t * 3];
+
+				const float score = vertexScores[candidate[0]] + vertexScores[candidate[1]] + vertexScores[candidate[2]];
+
+				if (score > bestScore)
+				{
+					bestScore = score;
+					bestTri = t;
+				}
+			}
+		}
+
+		cacheCount = (std::min)(newCacheCount, static_cast<size_t>(MESH_VERTEX_CACHE_SIZE));
+		memcpy(cache, newCache, cacheCount * sizeof(uint16_t));
+	}
+
+	memcpy(indices, output.data(), output.size() * sizeof(uint16_t));
+}
+
+//-----------------------------------------------------------------------------
+// purpose: reorders vertices by first use in the index list
+//-----------------------------------------------------------------------------
+void Mesh_OptimizeVertexFetch(uint16_t* const indices, const size_t indexCount, uint8_t* const vertices, const size_t vertexCount, const size_t vertexStride)
+{
+	constexpr uint32_t unassigned = UINT32_MAX;
+	std::vector<uint32_t> remap(vertexCount, unassigned);
+
+	uint32_t nextVertex = 0;
+
+	for (size_t i = 0; i < indexCount; i++)
+	{
+		const uint16_t index = indices[i];
+		assert(index < vertexCount);
+
+		if (remap[index] == unassigned)
+			remap[index] = nextVertex++;
+
+		indices[i] = static_cast<uint16_t>(remap[index]);
+	}
+
+	// keep the unreferenced vertices, in their original order.
+	for (size_t i = 0; i < vertexCount; i++)
+	{
+		if (remap[i] == unassigned)
+			remap[i] = nextVertex++;
+	}
+
+	std::unique_ptr<uint8_t[]> reordered(new uint8_t[vertexCount * vertexStride]);
+
+	for (size_t i = 0; i < vertexCount; i++)
+		memcpy(&reordered[remap[i] * vertexStride], &vertices[i * vertexStride], vertexStride);
+
+	memcpy(vertices, reordered.get(), vertexCount * vertexStride);
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+// size of the simulated post-transform vertex cache, used for both the
+// optimization and the ACMR (average cache miss ratio) statistics.
+#define MESH_VERTEX_CACHE_SIZE 32
+
+// average number of cache misses per triangle for a triangle list when ran
+// through a FIFO cache of given size; lower is better, 0.5 is the theoretical
+// minimum for large regular meshes and 3.0 the worst case.
+extern float Mesh_CalcACMR(const uint16_t* const indices, const size_t indexCount, const size_t vertexCount, const size_t cacheSize = MESH_VERTEX_CACHE_SIZE);
+
+// reorders the triangles in the triangle list for post-transform cache
+// efficiency using Tom Forsyth's linear-speed vertex cache optimization.
+extern void Mesh_OptimizeVertexCache(uint16_t* const indices, const size_t indexCount, const size_t vertexCount);
+
+// reorders the vertices in the order they are first referenced by the index
+// list for fetch locality, and remaps the indices accordingly. unreferenced
+// vertices are moved to the end. the vertex buffer must hold vertexCount
+// vertices of vertexStride bytes.
+extern void Mesh_OptimizeVertexFetch(uint16_t* const indices, const size_t indexCount, uint8_t* const vertices, const size_t vertexCount, const size_t vertexStride);
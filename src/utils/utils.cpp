@@ -155,7 +155,7 @@ bool Util_ReplaceStream(BinaryIO& mainStream, BinaryIO& toSwap, const char* cons
         Warning("%s: failed to remove file \"%s\" for swap.\n", __FUNCTION__, mainPath);
 
         // reopen and continue uncompressed.
-        if (mainStream.Open(mainPath, BinaryIO::Mode_e::ReadWrite))
+        if (!mainStream.Open(mainPath, BinaryIO::Mode_e::ReadWrite))
             Error("%s: failed to reopen file \"%s\".\n", __FUNCTION__, mainPath);
 
         return false;
@@ -171,6 +171,21 @@ bool Util_ReplaceStream(BinaryIO& mainStream, BinaryIO& toSwap, const char* cons
     return true;
 }
 
+void Util_TruncateStream(BinaryIO& stream, const char* const path, const size_t newSize)
+{
+    stream.Close();
+
+    // the stream must be closed as otherwise the file can't be resized.
+    std::error_code ec;
+    std::filesystem::resize_file(path, newSize, ec);
+
+    if (ec)
+        Error("%s: failed to resize file \"%s\" to %zu bytes: %s.\n", __FUNCTION__, path, newSize, ec.message().c_str());
+
+    if (!stream.Open(path, BinaryIO::Mode_e::ReadWrite))
+        Error("%s: failed to reopen file \"%s\".\n", __FUNCTION__, path);
+}
+
 PakGuid_t Pak_ParseGuid(const rapidjson::Value& val, bool* const success)
 {
     PakGuid_t guid;
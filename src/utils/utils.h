@@ -18,6 +18,7 @@ namespace Utils
 };
 
 extern bool Util_ReplaceStream(BinaryIO& mainStream, BinaryIO& toSwap, const char* const mainPath, const char* const toSwapPath);
+extern void Util_TruncateStream(BinaryIO& stream, const char* const path, const size_t newSize);
 
 extern PakGuid_t Pak_ParseGuid(const rapidjson::Value& val, bool* const success = nullptr);
 extern PakGuid_t Pak_ParseGuid(const rapidjson::Value& val, rapidjson::Value::StringRefType member, bool* const success = nullptr);
@@ -1,8 +1,37 @@
 #pragma once
 #include "thirdparty/zstd/zstd.h"
+#include "thirdparty/zstd/zdict.h"
 #include "thirdparty/zstd/compress/zstd_compress_internal.h"
 #include "thirdparty/zstd/decompress/zstd_decompress_internal.h"
 
+// The seek table of the zstd seekable format, stored in a skippable frame at
+// the end of the data. Each entry describes one independent frame, in order,
+// which allows readers to decode frames in parallel or to only decode the
+// frames covering a given range. Regular zstd stream decoders skip this frame.
+// See contrib/seekable_format/zstd_seekable_compression_format.md in the zstd
+// repository for the specification.
+#define ZSTD_SEEKABLE_MAGICNUMBER 0x8F92EAB1
+#define ZSTD_SEEKABLE_SKIPPABLE_MAGIC (ZSTD_MAGIC_SKIPPABLE_START | 0xE)
+#define ZSTD_SEEKABLE_CHECKSUM_FLAG (1 << 7)
+#define ZSTD_SEEKABLE_MAX_FRAME_SIZE (1ull << 30)
+
+#pragma pack(push, 1)
+struct ZSTDSeekTableEntry_s
+{
+	uint32_t compressedSize;
+	uint32_t decompressedSize;
+};
+
+struct ZSTDSeekTableFooter_s
+{
+	uint32_t numFrames;
+	uint8_t descriptor;
+	uint32_t seekableMagic;
+};
+#pragma pack(pop)
+
+static_assert(sizeof(ZSTDSeekTableFooter_s) == 9);
+
 struct ZSTDEncoder_s
 {
 	ZSTDEncoder_s();